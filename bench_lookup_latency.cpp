@@ -0,0 +1,371 @@
+#include "frozen_radix_tree.hpp"
+#include "ipv4_network.hpp"
+#include "latency_histogram.hpp"
+#include "prefix_vector.hpp"
+#include "radix_tree.hpp"
+#include "table_generator.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <sys/mman.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+# include <x86intrin.h>
+# define HAVE_RDTSC 1
+#endif
+
+// per-lookup latency distribution of find() for prefix_vector, radix_tree and frozen_radix_tree
+// on a large synthetic IPv4 table. prints one JSON object per line, container and mode.
+//
+// modes:
+// - hot: a handful of addresses looked up over and over (everything in L1 cache and TLB)
+// - random: addresses from uniformly chosen prefixes
+// - zipf: addresses from Zipf-distributed prefixes (popular prefixes stay cached)
+// - flushed: random addresses, but an eviction buffer (twice the last level cache) is read
+//   between two lookups. this displaces most of the table from the caches and many of its
+//   TLB entries, but not reliably all of them: replacement policies aren't strict LRU, and
+//   the buffer's pages only compete for some TLB sets. a warning is printed if the buffer
+//   is smaller than twice the last level cache
+//
+// the "*_hugepages" containers allocate from an arena advised to use transparent huge pages
+// (MADV_HUGEPAGE; needs THP in "madvise" or "always" mode); all other tables use the standard
+// allocator. to back those with 2M pages too run with GLIBC_TUNABLES=glibc.malloc.hugetlb=1
+// (transparent huge pages) or glibc.malloc.hugetlb=2 (reserved hugetlbfs pages).
+// "anon_huge_kb" in the output shows how much anonymous memory of the process actually is
+// backed by transparent huge pages.
+//
+// usage: bench_lookup_latency [prefixes [samples [flushed samples [eviction buffer MiB]]]]
+
+namespace {
+	// prevent the compiler from removing lookups without visible effect
+	volatile uint64_t g_sink;
+
+	struct bench_config {
+		size_t prefixes{1000000};
+		size_t samples{1000000};
+		size_t flushed_samples{1000};
+		size_t eviction_bytes{0}; // 0: twice the last level cache
+		size_t hot_addresses{16};
+		// address space reserved for the huge page arena (only used pages are backed by memory)
+		size_t arena_bytes{size_t{1} << 36};
+	};
+
+	// serializing timestamps: rdtsc if available, steady_clock nanoseconds otherwise
+	struct timer {
+#if defined(HAVE_RDTSC)
+		static uint64_t start() {
+			_mm_lfence();
+			uint64_t const t = __rdtsc();
+			_mm_lfence();
+			return t;
+		}
+
+		static uint64_t stop() {
+			unsigned int aux;
+			uint64_t const t = __rdtscp(&aux);
+			_mm_lfence();
+			return t;
+		}
+#else
+		static uint64_t start() {
+			return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+		}
+
+		static uint64_t stop() {
+			return start();
+		}
+#endif
+
+		// timer ticks per nanosecond
+		static double calibrate() {
+#if defined(HAVE_RDTSC)
+			auto const clock_start = std::chrono::steady_clock::now();
+			uint64_t const ticks_start = start();
+			while (std::chrono::steady_clock::now() - clock_start < std::chrono::milliseconds(100)) ;
+			uint64_t const ticks_end = stop();
+			auto const clock_end = std::chrono::steady_clock::now();
+			double const ns = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock_end - clock_start).count());
+			return static_cast<double>(ticks_end - ticks_start) / ns;
+#else
+			return 1.0;
+#endif
+		}
+
+		// smallest measurable interval (included in every sample)
+		static uint64_t overhead() {
+			uint64_t result = ~uint64_t{0};
+			for (size_t i = 0; i < 10000; ++i) {
+				uint64_t const t = start();
+				result = std::min(result, stop() - t);
+			}
+			return result;
+		}
+	};
+
+	size_t read_sysfs_size(char const* path) {
+		std::ifstream file(path);
+		size_t value = 0;
+		std::string unit;
+		if (!(file >> value)) return 0;
+		file >> unit;
+		if ("K" == unit) return value << 10;
+		if ("M" == unit) return value << 20;
+		return value;
+	}
+
+	// kB of anonymous memory backed by transparent huge pages
+	size_t anon_huge_kb() {
+		std::ifstream file("/proc/self/smaps_rollup");
+		std::string name;
+		size_t value;
+		while (file >> name) {
+			if ("AnonHugePages:" == name && file >> value) return value;
+		}
+		return 0;
+	}
+
+	class eviction_buffer {
+	private:
+		std::vector<uint64_t> m_data;
+
+	public:
+		explicit eviction_buffer(size_t bytes)
+		: m_data(bytes / sizeof(uint64_t), 1) {
+		}
+
+		size_t size() const { return m_data.size() * sizeof(uint64_t); }
+
+		// touch every cache line
+		void evict() {
+			uint64_t sum = 0;
+			for (size_t i = 0; i < m_data.size(); i += 64 / sizeof(uint64_t)) sum += m_data[i];
+			g_sink = sum;
+		}
+	};
+
+	// bump allocator on an anonymous mapping advised to use transparent huge pages;
+	// memory is only released when the arena is destroyed
+	class huge_page_arena {
+	private:
+		char* m_data{nullptr};
+		size_t m_size{0};
+		size_t m_used{0};
+
+	public:
+		explicit huge_page_arena(size_t size) {
+			void* const data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+			if (MAP_FAILED == data) return;
+			madvise(data, size, MADV_HUGEPAGE);
+			m_data = static_cast<char*>(data);
+			m_size = size;
+		}
+		huge_page_arena(huge_page_arena const& other) = delete;
+		huge_page_arena& operator=(huge_page_arena const& other) = delete;
+		~huge_page_arena() {
+			if (m_data) munmap(m_data, m_size);
+		}
+
+		bool valid() const { return nullptr != m_data; }
+
+		void* allocate(size_t bytes, size_t alignment) {
+			size_t const start = (m_used + alignment - 1) & ~(alignment - 1);
+			if (start > m_size || bytes > m_size - start) throw std::bad_alloc();
+			m_used = start + bytes;
+			return m_data + start;
+		}
+	};
+
+	template<typename T>
+	class arena_allocator {
+	private:
+		template<typename>
+		friend class arena_allocator;
+
+		huge_page_arena* m_arena;
+
+	public:
+		typedef T value_type;
+
+		explicit arena_allocator(huge_page_arena& arena)
+		: m_arena(&arena) {
+		}
+
+		template<typename U>
+		arena_allocator(arena_allocator<U> const& other)
+		: m_arena(other.m_arena) {
+		}
+
+		T* allocate(size_t n) {
+			return static_cast<T*>(m_arena->allocate(n * sizeof(T), alignof(T)));
+		}
+
+		void deallocate(T*, size_t) {
+		}
+
+		friend bool operator==(arena_allocator const& a, arena_allocator const& b) { return a.m_arena == b.m_arena; }
+		friend bool operator!=(arena_allocator const& a, arena_allocator const& b) { return a.m_arena != b.m_arena; }
+	};
+
+	class reporter {
+	private:
+		double m_ticks_per_ns;
+		uint64_t m_overhead;
+
+		double to_ns(uint64_t ticks) const {
+			return static_cast<double>(ticks) / m_ticks_per_ns;
+		}
+
+	public:
+		explicit reporter(double ticks_per_ns, uint64_t overhead)
+		: m_ticks_per_ns(ticks_per_ns), m_overhead(overhead) {
+		}
+
+		void operator()(char const* container, char const* mode, size_t prefixes, latency_histogram const& histogram) const {
+			std::cout
+				<< "{\"container\": \"" << container
+				<< "\", \"mode\": \"" << mode
+				<< "\", \"prefixes\": " << prefixes
+				<< ", \"samples\": " << histogram.count()
+				<< ", \"min\": " << to_ns(histogram.min())
+				<< ", \"mean\": " << histogram.mean() / m_ticks_per_ns
+				<< ", \"p50\": " << to_ns(histogram.value_at_percentile(50))
+				<< ", \"p90\": " << to_ns(histogram.value_at_percentile(90))
+				<< ", \"p99\": " << to_ns(histogram.value_at_percentile(99))
+				<< ", \"p999\": " << to_ns(histogram.value_at_percentile(99.9))
+				<< ", \"max\": " << to_ns(histogram.max())
+				<< ", \"timer_overhead\": " << to_ns(m_overhead)
+				<< ", \"anon_huge_kb\": " << anon_huge_kb()
+				<< ", \"unit\": \"ns\"}\n" << std::flush;
+		}
+	};
+
+	template<typename Table>
+	uint64_t timed_find(Table const& table, ipv4_network const& address) {
+		uint64_t const start = timer::start();
+		auto const it = table.find(address);
+		uint64_t const found = (it != table.end()) ? uint64_t{it->value()} : 0;
+		uint64_t const end = timer::stop();
+		g_sink = found;
+		return end - start;
+	}
+
+	struct workload {
+		std::vector<ipv4_network> hot;
+		std::vector<ipv4_network> random;
+		std::vector<ipv4_network> zipf;
+	};
+
+	template<typename Table>
+	void run(char const* container, Table const& table, workload const& load, bench_config const& config, eviction_buffer& eviction, reporter const& report) {
+		latency_histogram histogram;
+
+		// warm up
+		for (auto const& address: load.hot) timed_find(table, address);
+		for (size_t i = 0; i < config.samples; ++i) histogram.record(timed_find(table, load.hot[i % load.hot.size()]));
+		report(container, "hot", table.size(), histogram);
+
+		histogram.clear();
+		for (auto const& address: load.random) histogram.record(timed_find(table, address));
+		report(container, "random", table.size(), histogram);
+
+		histogram.clear();
+		for (auto const& address: load.zipf) histogram.record(timed_find(table, address));
+		report(container, "zipf", table.size(), histogram);
+
+		histogram.clear();
+		for (size_t i = 0; i < config.flushed_samples; ++i) {
+			eviction.evict();
+			histogram.record(timed_find(table, load.random[i % load.random.size()]));
+		}
+		report(container, "flushed", table.size(), histogram);
+	}
+}
+
+int main(int argc, char** argv) {
+	bench_config config;
+	if (argc > 1) config.prefixes = std::strtoul(argv[1], nullptr, 10);
+	if (argc > 2) config.samples = std::strtoul(argv[2], nullptr, 10);
+	if (argc > 3) config.flushed_samples = std::strtoul(argv[3], nullptr, 10);
+	if (argc > 4) config.eviction_bytes = std::strtoul(argv[4], nullptr, 10) << 20;
+	if (0 == config.prefixes || 0 == config.samples) {
+		std::cerr << "usage: " << argv[0] << " [prefixes [samples [flushed samples [eviction buffer MiB]]]]\n";
+		return 1;
+	}
+
+	size_t const llc = read_sysfs_size("/sys/devices/system/cpu/cpu0/cache/index3/size");
+	// every flushed sample reads the whole buffer: with large (e.g. virtual machine) caches
+	// reduce the flushed samples instead of the buffer
+	if (0 == config.eviction_bytes) config.eviction_bytes = 2 * (llc ? llc : size_t{32} << 20);
+	if (config.eviction_bytes < 2 * llc) {
+		std::cerr << "warning: eviction buffer (" << (config.eviction_bytes >> 20) << " MiB) is smaller than twice the last level cache ("
+			<< (llc >> 20) << " MiB); \"flushed\" results may include cache hits\n";
+	}
+
+	double const ticks_per_ns = timer::calibrate();
+	reporter const report(ticks_per_ns, timer::overhead());
+
+	table_generator generator;
+	std::vector<ipv4_network> const prefixes = generator.ipv4_table(config.prefixes);
+	workload load;
+	load.hot = generator.ipv4_addresses(prefixes, config.hot_addresses);
+	load.random = generator.ipv4_addresses(prefixes, config.samples);
+	load.zipf = generator.zipf_addresses(prefixes, config.samples);
+
+	eviction_buffer eviction(config.eviction_bytes);
+
+	std::vector<std::pair<ipv4_network, uint32_t>> entries;
+	entries.reserve(prefixes.size());
+	for (size_t i = 0; i < prefixes.size(); ++i) entries.emplace_back(prefixes[i], static_cast<uint32_t>(i));
+
+	{
+		prefix_vector<ipv4_network, uint32_t, ipv4_network_bitstring_traits> table;
+		table.insert_or_assign(entries.begin(), entries.end());
+		run("prefix_vector", table, load, config, eviction, report);
+	}
+
+	{
+		radix_tree<ipv4_network, uint32_t, ipv4_network_bitstring_traits> table;
+		table.insert_or_assign(entries.begin(), entries.end());
+		run("radix_tree", table, load, config, eviction, report);
+		auto const frozen = table.freeze();
+		run("frozen_radix_tree", frozen, load, config, eviction, report);
+	}
+
+	{
+		huge_page_arena arena(config.arena_bytes);
+		if (arena.valid()) {
+			arena_allocator<uint32_t> const allocator(arena);
+			prefix_vector<ipv4_network, uint32_t, ipv4_network_bitstring_traits, arena_allocator<uint32_t>> table(allocator);
+			table.insert_or_assign(entries.begin(), entries.end());
+			run("prefix_vector_hugepages", table, load, config, eviction, report);
+		} else {
+			std::perror("huge page arena");
+		}
+	}
+
+	{
+		huge_page_arena arena(config.arena_bytes);
+		if (arena.valid()) {
+			arena_allocator<uint32_t> const allocator(arena);
+			radix_tree<ipv4_network, uint32_t, ipv4_network_bitstring_traits, arena_allocator<uint32_t>> table(allocator);
+			table.insert_or_assign(entries.begin(), entries.end());
+			run("radix_tree_hugepages", table, load, config, eviction, report);
+		} else {
+			std::perror("huge page arena");
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,567 @@
+#include "bigendian_bitstring.hpp"
+#include "bloom_filtered_table.hpp"
+#include "cached_lookup.hpp"
+#include "compressed_prefix_vector.hpp"
+#include "fixed_prefix.hpp"
+#include "instrumentation.hpp"
+#include "ipv4_network.hpp"
+#include "ipv6_network.hpp"
+#include "length_search_table.hpp"
+#include "prefix_vector.hpp"
+#include "radix_tree.hpp"
+#include "sharded_prefix_table.hpp"
+#include "table_generator.hpp"
+#include "tree_bitmap.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// benchmarks for prefix_vector, radix_tree and frozen_radix_tree on synthetic full tables.
+// prints one JSON object per line and measurement:
+//   {"benchmark": "...", "container": "...", "key": "...", "prefixes": N, "value": X, "unit": "..."}
+//
+// when built with PREFIX_TABLE_INSTRUMENTATION the hot path counters of the lookup benchmarks
+// are reported too (as "<benchmark>.<counter>" in "count/op").
+//
+// usage: bench_prefix_tables [ipv4 prefixes [ipv6 prefixes [lookups]]]
+
+namespace {
+	typedef std::chrono::steady_clock clock_type;
+
+	double elapsed_ns(clock_type::time_point start, clock_type::time_point end) {
+		return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+	}
+
+	// prevent the compiler from removing lookups without visible effect
+	volatile size_t g_sink;
+
+	struct bench_config {
+		size_t ipv4_prefixes{200000};
+		size_t ipv6_prefixes{50000};
+		size_t lookups{1000000};
+		size_t updates{200};
+		size_t burst_size{1000};
+		size_t subtree_queries{10000};
+		size_t destinations{10000};
+		// for the parallel updates of sharded_prefix_table
+		size_t update_threads{4};
+		size_t update_rounds{20};
+	};
+
+	class reporter {
+	private:
+		char const* m_container;
+		char const* m_key;
+		size_t m_prefixes;
+
+	public:
+		explicit reporter(char const* container, char const* key, size_t prefixes)
+		: m_container(container), m_key(key), m_prefixes(prefixes) {
+		}
+
+		void operator()(char const* benchmark, double value, char const* unit) const {
+			std::cout
+				<< "{\"benchmark\": \"" << benchmark
+				<< "\", \"container\": \"" << m_container
+				<< "\", \"key\": \"" << m_key
+				<< "\", \"prefixes\": " << m_prefixes
+				<< ", \"value\": " << value
+				<< ", \"unit\": \"" << unit << "\"}\n";
+		}
+
+		// counters collected since the last instrumentation::reset()
+		void counters(char const* benchmark, size_t operations) const {
+#if defined(PREFIX_TABLE_INSTRUMENTATION)
+			auto const totals = instrumentation::aggregate();
+			for (size_t i = 0; i < instrumentation::COUNTER_COUNT; ++i) {
+				if (0 == totals.values[i]) continue;
+				std::string const name = std::string(benchmark) + "." + instrumentation::counter_name(static_cast<instrumentation::counter>(i));
+				(*this)(name.c_str(), static_cast<double>(totals.values[i]) / static_cast<double>(operations), "count/op");
+			}
+#endif
+		}
+	};
+
+	// IPv4 keys with the generic bigendian bitstring implementation
+	struct bigendian_ipv4 {
+		uint32_t addr;
+		uint8_t prefix;
+	};
+
+	bool operator==(bigendian_ipv4 const& a, bigendian_ipv4 const& b) {
+		return a.addr == b.addr && a.prefix == b.prefix;
+	}
+
+	struct bigendian_ipv4_hash {
+		size_t operator()(bigendian_ipv4 const& value) const {
+			return std::hash<ipv4_network>{}(ipv4_network(value.addr, value.prefix));
+		}
+	};
+
+	// IPv6 keys with the generic bigendian bitstring implementation
+	struct bigendian_ipv6 {
+		in6_addr addr;
+		uint8_t prefix;
+	};
+
+	bool operator==(bigendian_ipv6 const& a, bigendian_ipv6 const& b) {
+		return 0 == std::memcmp(a.addr.s6_addr, b.addr.s6_addr, sizeof(a.addr.s6_addr)) && a.prefix == b.prefix;
+	}
+
+	struct bigendian_ipv6_hash {
+		size_t operator()(bigendian_ipv6 const& value) const {
+			return std::hash<ipv6_network>{}(ipv6_network(value.addr, value.prefix));
+		}
+	};
+
+	template<typename Key>
+	struct key_hash : std::hash<Key> {
+	};
+
+	template<>
+	struct key_hash<bigendian_ipv4> : bigendian_ipv4_hash {
+	};
+
+	template<>
+	struct key_hash<bigendian_ipv6> : bigendian_ipv6_hash {
+	};
+
+	struct bigendian_ipv4_bitstring_traits {
+		typedef bigendian::bitstring bitstring;
+		typedef bigendian_ipv4 value_type;
+
+		bitstring value_to_bitstring(value_type const& value) {
+			return bigendian::bitstring(&value.addr, size_t{value.prefix});
+		}
+
+		value_type bitstring_to_value(bitstring bs) {
+			bs = bs.truncate(32);
+			bigendian_ipv4 result{0, static_cast<uint8_t>(bs.length())};
+			bs.set_bitstring(&result.addr, sizeof(result.addr));
+			return result;
+		}
+	};
+
+	struct bigendian_ipv6_bitstring_traits {
+		typedef bigendian::bitstring bitstring;
+		typedef bigendian_ipv6 value_type;
+
+		bitstring value_to_bitstring(value_type const& value) {
+			return bigendian::bitstring(value.addr.s6_addr, size_t{value.prefix});
+		}
+
+		value_type bitstring_to_value(bitstring bs) {
+			bs = bs.truncate(128);
+			bigendian_ipv6 result{in6_addr{}, static_cast<uint8_t>(bs.length())};
+			bs.set_bitstring(result.addr.s6_addr, sizeof(result.addr.s6_addr));
+			return result;
+		}
+	};
+
+	// conversion from the generated networks to the benchmarked key types;
+	// address() (if present) converts to the raw address type for lookups by address
+	struct to_ipv4_network {
+		ipv4_network operator()(ipv4_network network) const { return network; }
+		uint32_t address(ipv4_network network) const { return network.address(); }
+	};
+
+	struct to_fixed_prefix {
+		fixed_prefix<32, uint32_t> operator()(ipv4_network network) const {
+			return fixed_prefix<32, uint32_t>(network.native_address(), network.network());
+		}
+		uint32_t address(ipv4_network network) const { return network.native_address(); }
+	};
+
+	struct to_bigendian_ipv4 {
+		bigendian_ipv4 operator()(ipv4_network network) const {
+			return bigendian_ipv4{network.address(), network.network()};
+		}
+	};
+
+	struct to_ipv6_network {
+		ipv6_network operator()(ipv6_network network) const { return network; }
+		in6_addr address(ipv6_network network) const { return network.address(); }
+	};
+
+	struct to_bigendian_ipv6 {
+		bigendian_ipv6 operator()(ipv6_network network) const {
+			return bigendian_ipv6{network.address(), network.network()};
+		}
+	};
+
+	template<typename Key, typename Value, typename Traits>
+	auto subtree(prefix_vector<Key, Value, Traits> const& table, Key const& key) -> decltype(table.subkeys(key)) {
+		return table.subkeys(key);
+	}
+
+	template<typename Key, typename Value, typename Traits>
+	auto subtree(radix_tree<Key, Value, Traits> const& table, Key const& key) -> decltype(table.find_all(key)) {
+		return table.find_all(key);
+	}
+
+	template<typename Key, typename Value, typename Traits>
+	auto subtree(frozen_radix_tree<Key, Value, Traits> const& table, Key const& key) -> decltype(table.find_all(key)) {
+		return table.find_all(key);
+	}
+
+	template<typename Network>
+	struct workload {
+		std::vector<Network> prefixes;
+		std::vector<Network> random_addresses;
+		std::vector<Network> zipf_addresses;
+		// Zipf distributed over a fixed set of destination addresses
+		std::vector<Network> zipf_destinations;
+		// prefixes not in the table
+		std::vector<Network> updates;
+		std::vector<Network> burst;
+		// short prefixes for subtree iteration
+		std::vector<Network> subtree_roots;
+	};
+
+	// lookups by raw address (without key objects)
+	template<typename Table, typename Network, typename Convert>
+	auto bench_address_lookups(reporter const& report, Table const& table, workload<Network> const& load, Convert convert, int) -> decltype(table.value(convert.address(std::declval<Network>())), void()) {
+		std::vector<decltype(convert.address(std::declval<Network>()))> addresses;
+		addresses.reserve(load.random_addresses.size());
+		for (auto const& address: load.random_addresses) addresses.push_back(convert.address(address));
+
+		size_t found = 0;
+		auto const start = clock_type::now();
+		for (auto const& address: addresses) {
+			auto const* value = table.value(address);
+			if (value) found += *value;
+		}
+		auto const end = clock_type::now();
+		g_sink = found;
+		report("lookup_random_address", elapsed_ns(start, end) / static_cast<double>(addresses.size()), "ns/op");
+	}
+
+	template<typename Table, typename Network, typename Convert>
+	void bench_address_lookups(reporter const&, Table const&, workload<Network> const&, Convert, long) {
+	}
+
+	template<typename Table, typename Key>
+	auto bench_subtree_iteration(reporter const& report, Table const& table, std::vector<Key> const& keys, int) -> decltype(subtree(table, keys.front()), void()) {
+		size_t visited = 0;
+		auto const start = clock_type::now();
+		for (auto const& key: keys) {
+			for (auto const& elem: subtree(table, key)) visited += elem.value();
+		}
+		auto const end = clock_type::now();
+		g_sink = visited;
+		report("subtree_iteration", elapsed_ns(start, end) / static_cast<double>(keys.size()), "ns/op");
+	}
+
+	// table without subtree iteration
+	template<typename Table, typename Key>
+	void bench_subtree_iteration(reporter const&, Table const&, std::vector<Key> const&, long) {
+	}
+
+	template<typename Table, typename Key>
+	auto contains_exact(Table const& table, Key const& key, int) -> decltype(table.find_exact(key) != table.end()) {
+		return table.find_exact(key) != table.end();
+	}
+
+	// table without iterators
+	template<typename Table, typename Key>
+	bool contains_exact(Table const& table, Key const& key, long) {
+		return nullptr != table.value_exact(key);
+	}
+
+	template<typename Table, typename Network, typename Convert>
+	void bench_lookups(reporter const& report, Table const& table, workload<Network> const& load, size_t subtree_queries, Convert convert) {
+		typedef typename Table::key_t key_t;
+
+		auto const run_lookups = [&](char const* benchmark, std::vector<Network> const& addresses) {
+			std::vector<key_t> keys;
+			keys.reserve(addresses.size());
+			for (auto const& address: addresses) keys.push_back(convert(address));
+
+			size_t found = 0;
+			instrumentation::reset();
+			auto const start = clock_type::now();
+			for (auto const& key: keys) {
+				auto const* value = table.value(key);
+				if (value) found += *value;
+			}
+			auto const end = clock_type::now();
+			g_sink = found;
+			report(benchmark, elapsed_ns(start, end) / static_cast<double>(keys.size()), "ns/op");
+			report.counters(benchmark, keys.size());
+		};
+		run_lookups("lookup_random", load.random_addresses);
+		bench_address_lookups(report, table, load, convert, 0);
+		run_lookups("lookup_zipf", load.zipf_addresses);
+		run_lookups("lookup_zipf_destinations", load.zipf_destinations);
+
+		{
+			std::vector<key_t> keys;
+			keys.reserve(load.zipf_destinations.size());
+			for (auto const& address: load.zipf_destinations) keys.push_back(convert(address));
+			cached_lookup<Table, key_hash<key_t>> cache(table, 4096);
+
+			size_t found = 0;
+			auto const start = clock_type::now();
+			for (auto const& key: keys) {
+				auto const* value = cache.value(key);
+				if (value) found += *value;
+			}
+			auto const end = clock_type::now();
+			g_sink = found;
+			report("lookup_zipf_destinations_cached", elapsed_ns(start, end) / static_cast<double>(keys.size()), "ns/op");
+			report("lookup_zipf_destinations_cached_hit_rate", static_cast<double>(cache.hits()) / static_cast<double>(keys.size()), "ratio");
+		}
+
+		{
+			std::vector<key_t> keys;
+			for (size_t i = 0; i < load.random_addresses.size(); ++i) keys.push_back(convert(load.prefixes[i % load.prefixes.size()]));
+			size_t found = 0;
+			auto const start = clock_type::now();
+			for (auto const& key: keys) {
+				if (contains_exact(table, key, 0)) ++found;
+			}
+			auto const end = clock_type::now();
+			g_sink = found;
+			report("find_exact", elapsed_ns(start, end) / static_cast<double>(keys.size()), "ns/op");
+		}
+
+		{
+			std::vector<key_t> keys;
+			for (size_t i = 0; i < subtree_queries; ++i) keys.push_back(convert(load.subtree_roots[i % load.subtree_roots.size()]));
+			bench_subtree_iteration(report, table, keys, 0);
+		}
+
+		report("memory", static_cast<double>(table.memory_usage()) / static_cast<double>(table.size()), "bytes/prefix");
+	}
+
+	template<typename Table, typename Network, typename Convert>
+	void bench_updates(reporter const& report, Table& table, workload<Network> const& load, Convert convert) {
+		std::vector<double> insert_ns;
+		std::vector<double> erase_ns;
+		for (auto const& network: load.updates) {
+			auto const key = convert(network);
+			auto const start = clock_type::now();
+			table.insert_or_assign(key, 1u);
+			auto const middle = clock_type::now();
+			table.erase(key);
+			auto const end = clock_type::now();
+			insert_ns.push_back(elapsed_ns(start, middle));
+			erase_ns.push_back(elapsed_ns(middle, end));
+		}
+
+		auto const report_samples = [&](char const* mean_name, char const* p99_name, std::vector<double>& samples) {
+			double sum = 0;
+			for (double sample: samples) sum += sample;
+			std::sort(samples.begin(), samples.end());
+			report(mean_name, sum / static_cast<double>(samples.size()), "ns/op");
+			report(p99_name, samples[samples.size() * 99 / 100], "ns/op");
+		};
+		report_samples("update_insert_mean", "update_insert_p99", insert_ns);
+		report_samples("update_erase_mean", "update_erase_p99", erase_ns);
+
+		std::vector<std::pair<typename Table::key_t, typename Table::value_t>> burst;
+		for (auto const& network: load.burst) burst.emplace_back(convert(network), 1u);
+		auto const start = clock_type::now();
+		table.insert_or_assign(burst.begin(), burst.end());
+		auto const middle = clock_type::now();
+		for (auto const& elem: burst) table.erase(elem.first);
+		auto const end = clock_type::now();
+		report("burst_insert", elapsed_ns(start, middle) / static_cast<double>(burst.size()), "ns/op");
+		report("burst_erase", elapsed_ns(middle, end) / static_cast<double>(burst.size()), "ns/op");
+	}
+
+	template<typename Table, typename Network, typename Convert>
+	Table build(reporter const& report, workload<Network> const& load, Convert convert) {
+		std::vector<std::pair<typename Table::key_t, typename Table::value_t>> entries;
+		entries.reserve(load.prefixes.size());
+		for (size_t i = 0; i < load.prefixes.size(); ++i) {
+			entries.emplace_back(convert(load.prefixes[i]), static_cast<typename Table::value_t>(i));
+		}
+
+		Table table;
+		auto const start = clock_type::now();
+		table.insert_or_assign(entries.begin(), entries.end());
+		auto const end = clock_type::now();
+		report("build", elapsed_ns(start, end) / static_cast<double>(entries.size()), "ns/prefix");
+		return table;
+	}
+
+	template<typename Key, typename Traits, typename Network, typename Convert>
+	void bench_key(char const* key_name, workload<Network> const& load, bench_config const& config, Convert convert) {
+		{
+			reporter const report("prefix_vector", key_name, load.prefixes.size());
+			auto table = build<prefix_vector<Key, uint32_t, Traits>>(report, load, convert);
+			bench_lookups(report, table, load, config.subtree_queries, convert);
+			bench_updates(report, table, load, convert);
+		}
+		{
+			reporter const report("radix_tree", key_name, load.prefixes.size());
+			auto table = build<radix_tree<Key, uint32_t, Traits>>(report, load, convert);
+			bench_lookups(report, table, load, config.subtree_queries, convert);
+
+			reporter const frozen_report("frozen_radix_tree", key_name, load.prefixes.size());
+			auto const start = clock_type::now();
+			auto const frozen = table.freeze();
+			auto const end = clock_type::now();
+			frozen_report("build", elapsed_ns(start, end) / static_cast<double>(frozen.size()), "ns/prefix");
+			bench_lookups(frozen_report, frozen, load, config.subtree_queries, convert);
+
+			bench_updates(report, table, load, convert);
+		}
+		{
+			reporter const report("length_search_table", key_name, load.prefixes.size());
+			auto table = build<length_search_table<Key, uint32_t, Traits, key_hash<Key>>>(report, load, convert);
+			bench_lookups(report, table, load, config.subtree_queries, convert);
+			bench_updates(report, table, load, convert);
+		}
+		{
+			reporter const report("tree_bitmap", key_name, load.prefixes.size());
+			auto table = build<tree_bitmap<Key, uint32_t, Traits>>(report, load, convert);
+			bench_lookups(report, table, load, config.subtree_queries, convert);
+			bench_updates(report, table, load, convert);
+		}
+		{
+			reporter const report("bloom_prefix_vector", key_name, load.prefixes.size());
+			auto table = build<bloom_filtered_table<Key, uint32_t, Traits, prefix_vector<Key, uint32_t, Traits>, key_hash<Key>>>(report, load, convert);
+			bench_lookups(report, table, load, config.subtree_queries, convert);
+			bench_updates(report, table, load, convert);
+		}
+	}
+
+	// compressed_prefix_vector (only for bigendian::bitstring keys), built from a prefix_vector
+	template<typename Key, typename Traits, typename Network, typename Convert>
+	void bench_compressed(char const* key_name, workload<Network> const& load, bench_config const& config, Convert convert) {
+		std::vector<std::pair<Key, uint32_t>> entries;
+		entries.reserve(load.prefixes.size());
+		for (size_t i = 0; i < load.prefixes.size(); ++i) entries.emplace_back(convert(load.prefixes[i]), static_cast<uint32_t>(i));
+		prefix_vector<Key, uint32_t, Traits> source;
+		source.insert_or_assign(entries.begin(), entries.end());
+
+		// "build" is the compression only
+		reporter const report("compressed_prefix_vector", key_name, load.prefixes.size());
+		auto const start = clock_type::now();
+		compressed_prefix_vector<Key, uint32_t, Traits> const table(source);
+		auto const end = clock_type::now();
+		report("build", elapsed_ns(start, end) / static_cast<double>(table.size()), "ns/prefix");
+		bench_lookups(report, table, load, config.subtree_queries, convert);
+		report("key_memory", static_cast<double>(table.key_memory_usage()) / static_cast<double>(table.size()), "bytes/prefix");
+	}
+
+	// parallel inserts and erases (of the burst prefixes) in a sharded table, compared with
+	// the same updates from a single thread
+	template<typename Key, typename Traits, typename Table, typename Network, typename Convert>
+	void bench_sharded(char const* container, char const* key_name, workload<Network> const& load, bench_config const& config, Convert convert) {
+		reporter const report(container, key_name, load.prefixes.size());
+		std::vector<std::pair<Key, uint32_t>> entries;
+		entries.reserve(load.prefixes.size());
+		for (size_t i = 0; i < load.prefixes.size(); ++i) entries.emplace_back(convert(load.prefixes[i]), static_cast<uint32_t>(i));
+
+		sharded_prefix_table<Key, uint32_t, Traits, 8, Table> table;
+		{
+			auto const start = clock_type::now();
+			table.insert_or_assign(entries.begin(), entries.end());
+			auto const end = clock_type::now();
+			report("build", elapsed_ns(start, end) / static_cast<double>(entries.size()), "ns/prefix");
+		}
+
+		{
+			size_t found = 0;
+			uint32_t value;
+			auto const start = clock_type::now();
+			for (auto const& address: load.random_addresses) {
+				if (table.value(convert(address), value)) found += value;
+			}
+			auto const end = clock_type::now();
+			g_sink = found;
+			report("lookup_random", elapsed_ns(start, end) / static_cast<double>(load.random_addresses.size()), "ns/op");
+		}
+
+		std::vector<Key> burst;
+		for (auto const& network: load.burst) burst.push_back(convert(network));
+		auto const run_updates = [&](size_t first, size_t step) {
+			for (size_t round = 0; round < config.update_rounds; ++round) {
+				for (size_t i = first; i < burst.size(); i += step) table.insert_or_assign(burst[i], 1u);
+				for (size_t i = first; i < burst.size(); i += step) table.erase(burst[i]);
+			}
+		};
+		double const operations = static_cast<double>(2 * burst.size() * config.update_rounds);
+
+		{
+			auto const start = clock_type::now();
+			run_updates(0, 1);
+			auto const end = clock_type::now();
+			report("update_serial", elapsed_ns(start, end) / operations, "ns/op");
+		}
+
+		{
+			std::vector<std::thread> threads;
+			auto const start = clock_type::now();
+			for (size_t t = 0; t < config.update_threads; ++t) threads.emplace_back(run_updates, t, config.update_threads);
+			for (auto& thread: threads) thread.join();
+			auto const end = clock_type::now();
+			report("update_parallel", elapsed_ns(start, end) / operations, "ns/op");
+		}
+	}
+
+	template<typename Network, typename MakeTable, typename MakeAddresses>
+	workload<Network> make_workload(table_generator& generator, size_t prefixes, bench_config const& config, MakeTable make_table, MakeAddresses make_addresses, unsigned char max_subtree_root_length) {
+		workload<Network> load;
+		std::vector<Network> all = make_table(prefixes + config.updates + config.burst_size);
+		load.burst.assign(all.end() - static_cast<std::ptrdiff_t>(config.burst_size), all.end());
+		all.resize(all.size() - config.burst_size);
+		load.updates.assign(all.end() - static_cast<std::ptrdiff_t>(config.updates), all.end());
+		all.resize(prefixes);
+		load.prefixes = std::move(all);
+
+		load.random_addresses = make_addresses(load.prefixes, config.lookups);
+		load.zipf_addresses = generator.zipf_addresses(load.prefixes, config.lookups);
+		// full length addresses: zipf_addresses() returns them unchanged
+		load.zipf_destinations = generator.zipf_addresses(make_addresses(load.prefixes, config.destinations), config.lookups);
+		for (auto const& network: load.prefixes) {
+			if (network.network() <= max_subtree_root_length) load.subtree_roots.push_back(network);
+		}
+		if (load.subtree_roots.empty()) load.subtree_roots = load.prefixes;
+		return load;
+	}
+}
+
+int main(int argc, char** argv) {
+	bench_config config;
+	if (argc > 1) config.ipv4_prefixes = std::strtoul(argv[1], nullptr, 10);
+	if (argc > 2) config.ipv6_prefixes = std::strtoul(argv[2], nullptr, 10);
+	if (argc > 3) config.lookups = std::strtoul(argv[3], nullptr, 10);
+
+	table_generator generator;
+
+	if (config.ipv4_prefixes > 0) {
+		auto const load = make_workload<ipv4_network>(generator, config.ipv4_prefixes, config,
+			[&](size_t count) { return generator.ipv4_table(count); },
+			[&](std::vector<ipv4_network> const& table, size_t count) { return generator.ipv4_addresses(table, count); },
+			16);
+		bench_key<ipv4_network, ipv4_network_bitstring_traits>("ipv4_network", load, config, to_ipv4_network{});
+		bench_sharded<ipv4_network, ipv4_network_bitstring_traits, prefix_vector<ipv4_network, uint32_t, ipv4_network_bitstring_traits>>("sharded_prefix_vector", "ipv4_network", load, config, to_ipv4_network{});
+		bench_sharded<ipv4_network, ipv4_network_bitstring_traits, radix_tree<ipv4_network, uint32_t, ipv4_network_bitstring_traits>>("sharded_radix_tree", "ipv4_network", load, config, to_ipv4_network{});
+		bench_key<fixed_prefix<32, uint32_t>, fixed_prefix_bitstring_traits<32, uint32_t>>("fixed_prefix<32>", load, config, to_fixed_prefix{});
+		bench_key<bigendian_ipv4, bigendian_ipv4_bitstring_traits>("bigendian_ipv4", load, config, to_bigendian_ipv4{});
+		bench_compressed<bigendian_ipv4, bigendian_ipv4_bitstring_traits>("bigendian_ipv4", load, config, to_bigendian_ipv4{});
+	}
+
+	if (config.ipv6_prefixes > 0) {
+		auto const load = make_workload<ipv6_network>(generator, config.ipv6_prefixes, config,
+			[&](size_t count) { return generator.ipv6_table(count); },
+			[&](std::vector<ipv6_network> const& table, size_t count) { return generator.ipv6_addresses(table, count); },
+			32);
+		bench_key<ipv6_network, ipv6_network_bitstring_traits>("ipv6_network", load, config, to_ipv6_network{});
+		bench_key<bigendian_ipv6, bigendian_ipv6_bitstring_traits>("bigendian_ipv6", load, config, to_bigendian_ipv6{});
+		bench_compressed<bigendian_ipv6, bigendian_ipv6_bitstring_traits>("bigendian_ipv6", load, config, to_bigendian_ipv6{});
+	}
+
+	return 0;
+}
@@ -1,8 +1,79 @@
 #include "bigendian_bitstring.hpp"
+#include "builtins.hpp"
 
 #include <cstring>
 
+#if defined(__SSE2__)
+# include <emmintrin.h>
+#endif
+#if defined(__AVX2__)
+# include <immintrin.h>
+#endif
+
 namespace bigendian {
+	namespace {
+		// load 8 bytes as big endian word; `p` must have at least 8 readable bytes
+		uint64_t load_word(unsigned char const* p) {
+			uint64_t word;
+			std::memcpy(&word, p, sizeof(word));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+			return word;
+#elif defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ && (defined(__GNUC__) || PREFIX_TABLE_HAS_BUILTIN(__builtin_bswap64))
+			return __builtin_bswap64(word);
+#else
+			unsigned char const* bytes = reinterpret_cast<unsigned char const*>(&word);
+			uint64_t result = 0;
+			for (size_t i = 0; i < sizeof(word); ++i) result = (result << 8) | bytes[i];
+			return result;
+#endif
+		}
+
+		// load `bytes` (< 8) bytes as the high part of a big endian word; never reads past p[bytes-1]
+		uint64_t load_partial_word(unsigned char const* p, size_t bytes) {
+			assert(bytes < 8);
+			unsigned char buf[8] = { 0 };
+			std::memcpy(buf, p, bytes);
+			return load_word(buf);
+		}
+
+		// index of the first bit in which `a` and `b` differ, only looking at the first `length` bits.
+		// returns `length` if they are equal.
+		// only reads the (length+7)/8 bytes of each string a bitstring of that length covers.
+		size_t first_difference(unsigned char const* a, unsigned char const* b, size_t length) {
+			size_t const bytes = (length + 7) / 8;
+			size_t pos = 0; // in bytes
+
+			// skip over long equal blocks; the exact position is found by the word loop below
+#if defined(__AVX2__)
+			for (; pos + 32 <= bytes; pos += 32) {
+				__m256i const va = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(a + pos));
+				__m256i const vb = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(b + pos));
+				if (~0u != static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb)))) break;
+			}
+#endif
+#if defined(__SSE2__)
+			for (; pos + 16 <= bytes; pos += 16) {
+				__m128i const va = _mm_loadu_si128(reinterpret_cast<__m128i const*>(a + pos));
+				__m128i const vb = _mm_loadu_si128(reinterpret_cast<__m128i const*>(b + pos));
+				if (0xffff != _mm_movemask_epi8(_mm_cmpeq_epi8(va, vb))) break;
+			}
+#endif
+
+			for (; pos + 8 <= bytes; pos += 8) {
+				uint64_t const diff = load_word(a + pos) ^ load_word(b + pos);
+				if (0 != diff) return std::min(length, 8*pos + builtins_detail::count_leading_zeros(diff));
+			}
+
+			if (pos < bytes) {
+				size_t const tail = bytes - pos;
+				uint64_t const diff = load_partial_word(a + pos, tail) ^ load_partial_word(b + pos, tail);
+				if (0 != diff) return std::min(length, 8*pos + builtins_detail::count_leading_zeros(diff));
+			}
+
+			return length;
+		}
+	}
+
 	bool bitstring::operator[](size_t bit_ndx) const {
 		return 0 != get_bit(bit_ndx);
 	}
@@ -42,11 +113,77 @@ namespace bigendian {
 		return byte_data()[(m_length / 8)] & content_mask(m_length);
 	}
 
+	size_t bitstring::string_length(size_t length) {
+		size_t length_digits = 1;
+		for (size_t rem = length; rem >= 10; rem /= 10) ++length_digits;
+		return 2*((length + 7) / 8) + 1 + length_digits;
+	}
+
+	char* format_to(char* out, bitstring const& value) {
+		static char const hex_digits[] = "0123456789abcdef";
+		size_t const full_bytes = value.length() / 8;
+		for (size_t i = 0; i < full_bytes; ++i) {
+			unsigned char const byte = value.get_byte(i);
+			*out++ = hex_digits[byte >> 4];
+			*out++ = hex_digits[byte & 0xfu];
+		}
+		if (0 != value.length() % 8) {
+			unsigned char const byte = value.fraction_byte();
+			*out++ = hex_digits[byte >> 4];
+			*out++ = hex_digits[byte & 0xfu];
+		}
+		*out++ = '/';
+		char* const digits_begin = out;
+		size_t length = value.length();
+		do {
+			*out++ = static_cast<char>('0' + length % 10);
+			length /= 10;
+		} while (0 != length);
+		std::reverse(digits_begin, out);
+		return out;
+	}
+
+	bool parse_bitstring(char const* str, size_t length, void* data, size_t data_size, bitstring& result) {
+		unsigned char* const dest = reinterpret_cast<unsigned char*>(data);
+		char const* pos = str;
+		char const* const end = str + length;
+
+		std::memset(dest, 0, data_size);
+		size_t digits = 0;
+		for (; pos != end && '/' != *pos; ++pos, ++digits) {
+			unsigned char nibble;
+			if (*pos >= '0' && *pos <= '9') {
+				nibble = static_cast<unsigned char>(*pos - '0');
+			} else if (*pos >= 'a' && *pos <= 'f') {
+				nibble = static_cast<unsigned char>(*pos - 'a' + 10);
+			} else if (*pos >= 'A' && *pos <= 'F') {
+				nibble = static_cast<unsigned char>(*pos - 'A' + 10);
+			} else {
+				return false;
+			}
+			if (digits / 2 >= data_size) return false;
+			dest[digits / 2] = static_cast<unsigned char>(dest[digits / 2] | (0 == digits % 2 ? nibble << 4 : nibble));
+		}
+
+		size_t bits = 4*digits;
+		if (pos != end) {
+			++pos; // skip '/'
+			if (pos == end) return false;
+			bits = 0;
+			for (; pos != end; ++pos) {
+				if (*pos < '0' || *pos > '9' || bits > 4*digits) return false;
+				bits = 10*bits + static_cast<size_t>(*pos - '0');
+			}
+			if (bits > 4*digits) return false;
+		}
+
+		result = bitstring(data, bits);
+		return true;
+	}
+
 	bool operator==(bitstring const& a, bitstring const& b) {
 		if (a.length() != b.length()) return false;
-		size_t const full_bytes = a.length() / 8;
-		if (0 != full_bytes && 0 != std::memcmp(a.byte_data(), b.byte_data(), full_bytes)) return false;
-		return a.fraction_byte() == b.fraction_byte();
+		return a.length() == first_difference(a.byte_data(), b.byte_data(), a.length());
 	}
 
 	bool operator!=(bitstring const& a, bitstring const& b) {
@@ -55,16 +192,10 @@ namespace bigendian {
 
 	bool is_lexicographic_less(bitstring const& a, bitstring const& b) {
 		size_t const min_len = std::min(a.length(), b.length());
-		bitstring const a_trunc = a.truncate(min_len);
-		bitstring const b_trunc = b.truncate(min_len);
-
-		size_t const full_bytes = min_len / 8;
-		if (0 != full_bytes) {
-			int cmp = std::memcmp(a_trunc.byte_data(), b_trunc.byte_data(), full_bytes);
-			if (0 != cmp) return cmp < 0;
-		}
-		if (a_trunc.fraction_byte() != b_trunc.fraction_byte()) {
-			return a_trunc.fraction_byte() < b_trunc.fraction_byte();
+		size_t const diff = first_difference(a.byte_data(), b.byte_data(), min_len);
+		if (diff < min_len) {
+			// a is smaller if it has a 0 where b has a 1
+			return 0 != b.get_bit(diff);
 		}
 		// the one with shorter length is prefix of the other
 		return a.length() < b.length();
@@ -72,23 +203,17 @@ namespace bigendian {
 
 	bool is_tree_less(bitstring const& a, bitstring const& b) {
 		size_t const min_len = std::min(a.length(), b.length());
-		bitstring const a_trunc = a.truncate(min_len);
-		bitstring const b_trunc = b.truncate(min_len);
-
-		size_t const full_bytes = min_len / 8;
-		if (0 != full_bytes) {
-			int cmp = std::memcmp(a_trunc.byte_data(), b_trunc.byte_data(), full_bytes);
-			if (0 != cmp) return cmp < 0;
-		}
-		if (a_trunc.fraction_byte() != b_trunc.fraction_byte()) {
-			return a_trunc.fraction_byte() < b_trunc.fraction_byte();
+		size_t const diff = first_difference(a.byte_data(), b.byte_data(), min_len);
+		if (diff < min_len) {
+			return 0 != b.get_bit(diff);
 		}
 		// the one with shorter length is prefix of the other
 		if (a.length() < b.length()) { // a is prefix of b
-			// if 0 == b.get_bit(min_len + 1) the b hangs is on the left of ancestor a
-			return 0 == b.get_bit(min_len + 1);
+			// if 1 == b[min_len] then b hangs on the right of ancestor a
+			return 0 != b.get_bit(min_len);
 		} else if (a.length() > b.length()) { // b is prefix of a
-			return 0 == a.get_bit(min_len + 1);
+			// if 0 == a[min_len] then a hangs on the left of ancestor b
+			return 0 == a.get_bit(min_len);
 		} else {
 			return false; // equal
 		}
@@ -96,18 +221,12 @@ namespace bigendian {
 
 	bool is_prefix(bitstring const& prefix, bitstring const& str) {
 		if (str.length() < prefix.length()) return false;
-		bitstring const str_trunc = str.truncate(prefix.length());
-		return prefix == str_trunc;
+		return prefix.length() == first_difference(prefix.byte_data(), str.byte_data(), prefix.length());
 	}
 
 	bitstring longest_common_prefix(bitstring const& a, bitstring const& b) {
 		size_t const min_len = std::min(a.length(), b.length());
-		size_t common = 0;
-		for (size_t i = 0; i < min_len / 8; ++i, common += 8) {
-			if (a.get_byte(i) != b.get_byte(i)) break;
-		}
-		while (common < min_len && a.get_bit(common) == b.get_bit(common)) ++common;
-		return a.truncate(common);
+		return a.truncate(first_difference(a.byte_data(), b.byte_data(), min_len));
 	}
 
 }
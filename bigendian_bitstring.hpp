@@ -46,8 +46,19 @@ namespace bigendian {
 		// return bits of last (incomplete) byte (masks out unused bits);
 		// return 0 if there is no incomplete byte.
 		unsigned char fraction_byte() const;
+
+		// length of the text representation (see format_to) of a bitstring with `length` bits
+		static size_t string_length(size_t length);
 	};
 
+	// writes the (partial) bytes as hex digits followed by "/length" to out
+	// (needs bitstring::string_length(value.length()) bytes, no terminating NUL); returns end of text
+	char* format_to(char* out, bitstring const& value);
+
+	// parses hex digits optionally followed by "/length" (defaults to 4 bits per digit); stores the bytes
+	// in data and points result to it. returns false on malformed input or if data_size is too small.
+	bool parse_bitstring(char const* str, size_t length, void* data, size_t data_size, bitstring& result);
+
 	/* bitstring "concept": */
 
 	bool operator==(bitstring const& a, bitstring const& b);
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <utility>
+
 /* BitString concept:
    type `S` satisfies `BitString` if
    - `S` satisfies `MoveConstructible`
@@ -27,3 +29,32 @@
 
    `BitString`s do not necessarily own the data of the bitstring they contain, they might simply contain a pointer to the data.
  */
+
+/* KeyBitStringTraits concept:
+   - `typedef ... bitstring`: a type satisfying `BitString`
+   - `typedef ... value_type`: the key type
+   - `t.value_to_bitstring(key)` and `t.bitstring_to_value(bs)` converting between keys and bitstrings
+   Optionally (for lookups by address without constructing key objects):
+   - `t.address_to_bitstring(address)`: returns the full length bitstring for an `address` of
+     some other type, e.g. a raw IPv4 address
+ */
+
+namespace bitstring_detail {
+	template<typename KeyBitStringTraits, typename Address>
+	auto address_to_bitstring(Address const& address, int) -> decltype(std::declval<KeyBitStringTraits&>().address_to_bitstring(address)) {
+		KeyBitStringTraits keyBitStringTraits{};
+		return keyBitStringTraits.address_to_bitstring(address);
+	}
+
+	template<typename KeyBitStringTraits>
+	typename KeyBitStringTraits::bitstring address_to_bitstring(typename KeyBitStringTraits::bitstring const& bs, long) {
+		return bs;
+	}
+}
+
+// bitstring for an address supported by `KeyBitStringTraits::address_to_bitstring`, or the bitstring
+// itself; doesn't participate in overload resolution for other types
+template<typename KeyBitStringTraits, typename Address>
+auto traits_address_to_bitstring(Address const& address) -> decltype(bitstring_detail::address_to_bitstring<KeyBitStringTraits>(address, 0)) {
+	return bitstring_detail::address_to_bitstring<KeyBitStringTraits>(address, 0);
+}
@@ -0,0 +1,319 @@
+#pragma once
+
+#include "bitstring.hpp"
+#include "prefix_vector.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+// longest prefix match through exact lookups, guided by a counting Bloom filter over all
+// (prefix length, key) pairs of a prefix_vector or radix_tree.
+//
+// a lookup first tests the truncations of the key to all populated prefix lengths against the
+// filter (independent hashes and one cache line per length, so the tests don't wait for each
+// other), and then calls Table::find_exact() only for the lengths which passed, from the longest
+// to the shortest; the first hit is the longest match. lengths without a matching prefix
+// are (apart from false positives) never probed in the table.
+//
+// the wrapper only holds the filter and per-length counts (a few bytes per key); every
+// candidate still costs a find_exact() in the table, and every populated length a key
+// construction and a hash. it pays off when exact probes are expensive compared to that
+// (many lengths without a match, table far from the cpu), not over a table which already
+// finds the longest match in a few cache misses.
+//
+// the filter is "blocked": all counters of a key are in one 64 byte block. counters are 8 bit
+// and saturate (a saturated counter is never decremented again). the filter grows with the
+// table (and then is rebuilt from all keys).
+template<
+	typename Key,
+	typename Value,
+	typename KeyBitStringTraits,
+	typename Table = prefix_vector<Key, Value, KeyBitStringTraits>,
+	typename Hash = std::hash<Key>>
+class bloom_filtered_table {
+public:
+	typedef Key key_t;
+	typedef Value value_t;
+	typedef Table table_t;
+	typedef typename table_t::iterator iterator;
+	typedef typename table_t::const_iterator const_iterator;
+
+	// counters per key and counters (bytes) per block
+	static constexpr unsigned int HASH_COUNT{4};
+	static constexpr size_t BLOCK_SIZE{64};
+
+private:
+	typedef typename KeyBitStringTraits::bitstring bitstring;
+
+	table_t m_table;
+	// filter capacity is m_counters_per_key counters for each key
+	size_t m_counters_per_key;
+	std::vector<uint8_t> m_counters;
+	size_t m_blocks{0};
+	size_t m_capacity{0};
+	// number of keys for each prefix length
+	std::vector<size_t> m_length_counts;
+	// populated prefix lengths, longest first
+	std::vector<size_t> m_lengths;
+
+	static bitstring key_to_bs(key_t const& key) {
+		KeyBitStringTraits keyBitStringTraits{};
+		return keyBitStringTraits.value_to_bitstring(key);
+	}
+
+	static key_t bs_to_key(bitstring const& bs) {
+		KeyBitStringTraits keyBitStringTraits{};
+		return keyBitStringTraits.bitstring_to_value(bs);
+	}
+
+	// mix the (possibly weak) Hash result (finalizer of MurmurHash3)
+	static uint64_t hash(key_t const& key) {
+		uint64_t h = static_cast<uint64_t>(Hash{}(key));
+		h ^= h >> 33;
+		h *= UINT64_C(0xff51afd7ed558ccd);
+		h ^= h >> 33;
+		h *= UINT64_C(0xc4ceb9fe1a85ec53);
+		h ^= h >> 33;
+		return h;
+	}
+
+	// first counter of the block for hash h
+	size_t block_offset(uint64_t h) const {
+		// high bits select the block, low bits the counters within
+		return static_cast<size_t>(((h >> 32) * m_blocks) >> 32) * BLOCK_SIZE;
+	}
+
+	static size_t counter_index(uint64_t h, unsigned int i) {
+		return static_cast<size_t>((h >> (6 * i)) % BLOCK_SIZE);
+	}
+
+	bool maybe_contains(uint64_t h) const {
+		uint8_t const* const block = m_counters.data() + block_offset(h);
+		bool result = true;
+		for (unsigned int i = 0; i < HASH_COUNT; ++i) result &= (0 != block[counter_index(h, i)]);
+		return result;
+	}
+
+	void filter_add(uint64_t h) {
+		uint8_t* const block = m_counters.data() + block_offset(h);
+		for (unsigned int i = 0; i < HASH_COUNT; ++i) {
+			uint8_t& counter = block[counter_index(h, i)];
+			if (0xff != counter) ++counter;
+		}
+	}
+
+	void filter_remove(uint64_t h) {
+		uint8_t* const block = m_counters.data() + block_offset(h);
+		for (unsigned int i = 0; i < HASH_COUNT; ++i) {
+			uint8_t& counter = block[counter_index(h, i)];
+			if (0xff != counter) --counter;
+		}
+	}
+
+	void rebuild_filter(size_t capacity) {
+		m_capacity = std::max<size_t>(capacity, 64);
+		m_blocks = (m_capacity * m_counters_per_key + BLOCK_SIZE - 1) / BLOCK_SIZE;
+		m_counters.assign(m_blocks * BLOCK_SIZE, 0);
+		for (auto const& elem: m_table) filter_add(hash(elem.key()));
+	}
+
+	void added(key_t const& key) {
+		size_t const length = key_to_bs(key).length();
+		if (length >= m_length_counts.size()) m_length_counts.resize(length + 1, 0);
+		if (0 == m_length_counts[length]++) {
+			m_lengths.insert(std::upper_bound(m_lengths.begin(), m_lengths.end(), length, std::greater<size_t>()), length);
+		}
+		if (m_table.size() > m_capacity) {
+			rebuild_filter(2 * m_table.size());
+		} else {
+			filter_add(hash(key));
+		}
+	}
+
+	void removed(key_t const& key) {
+		size_t const length = key_to_bs(key).length();
+		if (0 == --m_length_counts[length]) {
+			m_lengths.erase(std::find(m_lengths.begin(), m_lengths.end(), length));
+		}
+		filter_remove(hash(key));
+	}
+
+	template<typename T>
+	auto intern_find(T& table, bitstring const& key_bs) const -> decltype(table.end()) {
+		// up to 129 lengths (IPv6)
+		size_t const max_lengths = 256;
+		size_t candidates[max_lengths];
+		size_t candidate_count = 0;
+		// first test all lengths ...
+		// (without branches on the result, so the filter loads for all lengths overlap)
+		for (size_t length: m_lengths) {
+			if (length > key_bs.length()) continue;
+			candidates[candidate_count] = length;
+			candidate_count += maybe_contains(hash(bs_to_key(key_bs.truncate(length)))) ? 1 : 0;
+			if (max_lengths == candidate_count) break;
+		}
+		// ... then probe the table, longest length first
+		for (size_t i = 0; i < candidate_count; ++i) {
+			auto const it = table.find_exact(bs_to_key(key_bs.truncate(candidates[i])));
+			if (it != table.end()) return it;
+		}
+		if (max_lengths == candidate_count) return table.find(bs_to_key(key_bs));
+		return table.end();
+	}
+
+public:
+	explicit bloom_filtered_table(size_t counters_per_key = 8)
+	: m_counters_per_key(counters_per_key) {
+		rebuild_filter(0);
+	}
+
+	// the underlying table (must not be modified directly)
+	table_t const& table() const {
+		return m_table;
+	}
+
+	// find entry with longest matching prefix of key (or end())
+	const_iterator find(key_t const& key) const {
+		return intern_find(m_table, key_to_bs(key));
+	}
+
+	iterator find(key_t const& key) {
+		return intern_find(m_table, key_to_bs(key));
+	}
+
+	const_iterator find_exact(key_t const& key) const {
+		return m_table.find_exact(key);
+	}
+
+	iterator find_exact(key_t const& key) {
+		return m_table.find_exact(key);
+	}
+
+	// value from entry found with find() or nullptr
+	value_t const* value(key_t const& key) const {
+		auto const it = find(key);
+		return (it == m_table.end()) ? nullptr : &it->value();
+	}
+
+	value_t* value(key_t const& key) {
+		auto const it = find(key);
+		return (it == m_table.end()) ? nullptr : &it->value();
+	}
+
+	// same by address (see KeyBitStringTraits::address_to_bitstring in bitstring.hpp)
+	template<typename Address, typename = decltype(traits_address_to_bitstring<KeyBitStringTraits>(std::declval<Address const&>()))>
+	const_iterator find(Address const& address) const {
+		return intern_find(m_table, traits_address_to_bitstring<KeyBitStringTraits>(address));
+	}
+
+	template<typename Address, typename = decltype(traits_address_to_bitstring<KeyBitStringTraits>(std::declval<Address const&>()))>
+	value_t const* value(Address const& address) const {
+		auto const it = find(address);
+		return (it == m_table.end()) ? nullptr : &it->value();
+	}
+
+	// insert, but don't overwrite existing entry (returns false if key is already present)
+	template<typename ValueArg>
+	std::pair<iterator, bool> insert(key_t const& key, ValueArg&& value) {
+		size_t const old_size = m_table.size();
+		auto const result = m_table.insert(key, std::forward<ValueArg>(value));
+		if (m_table.size() != old_size) added(key);
+		return result;
+	}
+
+	// insert, or assign if key is already present
+	template<typename ValueArg>
+	std::pair<iterator, bool> insert_or_assign(key_t const& key, ValueArg&& value) {
+		size_t const old_size = m_table.size();
+		auto const result = m_table.insert_or_assign(key, std::forward<ValueArg>(value));
+		if (m_table.size() != old_size) added(key);
+		return result;
+	}
+
+	// insert all (key, value) pairs from the given range, but don't overwrite existing entries
+	template<typename InputIterator>
+	void insert(InputIterator first, InputIterator last) {
+		m_table.insert(first, last);
+		rebuild();
+	}
+
+	// insert, or assign if key is already present, all (key, value) pairs from the given range
+	template<typename InputIterator>
+	void insert_or_assign(InputIterator first, InputIterator last) {
+		m_table.insert_or_assign(first, last);
+		rebuild();
+	}
+
+	// erase element with given key. returns how many elements were deleted (0 or 1)
+	size_t erase(key_t const& key) {
+		size_t const result = m_table.erase(key);
+		if (result) removed(key);
+		return result;
+	}
+
+	// rebuild filter and prefix length statistics from the table
+	void rebuild() {
+		m_length_counts.clear();
+		m_lengths.clear();
+		for (auto const& elem: m_table) {
+			size_t const length = key_to_bs(elem.key()).length();
+			if (length >= m_length_counts.size()) m_length_counts.resize(length + 1, 0);
+			if (0 == m_length_counts[length]++) m_lengths.push_back(length);
+		}
+		std::sort(m_lengths.begin(), m_lengths.end(), std::greater<size_t>());
+		rebuild_filter(2 * m_table.size());
+	}
+
+	bool empty() const {
+		return m_table.empty();
+	}
+
+	size_t size() const {
+		return m_table.size();
+	}
+
+	// number of populated prefix lengths
+	size_t length_count() const {
+		return m_lengths.size();
+	}
+
+	// bytes allocated for the table and the filter (not counting memory owned by keys or values)
+	size_t memory_usage() const {
+		return m_table.memory_usage() - sizeof(m_table) + sizeof(*this) + m_counters.capacity()
+			+ (m_length_counts.capacity() + m_lengths.capacity()) * sizeof(size_t);
+	}
+
+	// changes on every modification of the table (see table_generation)
+	uint64_t generation() const {
+		return m_table.generation();
+	}
+
+	friend void swap(bloom_filtered_table& a, bloom_filtered_table& b) {
+		using std::swap;
+		swap(a.m_table, b.m_table);
+		swap(a.m_counters_per_key, b.m_counters_per_key);
+		swap(a.m_counters, b.m_counters);
+		swap(a.m_blocks, b.m_blocks);
+		swap(a.m_capacity, b.m_capacity);
+		swap(a.m_length_counts, b.m_length_counts);
+		swap(a.m_lengths, b.m_lengths);
+	}
+
+	iterator begin() { return m_table.begin(); }
+	iterator end() { return m_table.end(); }
+	const_iterator begin() const { return m_table.begin(); }
+	const_iterator end() const { return m_table.end(); }
+	const_iterator cbegin() const { return m_table.cbegin(); }
+	const_iterator cend() const { return m_table.cend(); }
+};
+
+template<typename Key, typename Value, typename KeyBitStringTraits, typename Table, typename Hash>
+constexpr unsigned int bloom_filtered_table<Key, Value, KeyBitStringTraits, Table, Hash>::HASH_COUNT;
+
+template<typename Key, typename Value, typename KeyBitStringTraits, typename Table, typename Hash>
+constexpr size_t bloom_filtered_table<Key, Value, KeyBitStringTraits, Table, Hash>::BLOCK_SIZE;
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <limits>
+#include <type_traits>
+
+#include <cassert>
+
+#include <stddef.h>
+
+// internal helpers around compiler builtins (with portable fallbacks)
+
+// PREFIX_TABLE_HAS_BUILTIN(x): whether the compiler reports builtin x (0 if it can't tell)
+#if defined(__has_builtin)
+# define PREFIX_TABLE_HAS_BUILTIN(x) __has_builtin(x)
+#else
+# define PREFIX_TABLE_HAS_BUILTIN(x) 0
+#endif
+
+namespace builtins_detail {
+	// number of leading zero bits in a native unsigned integer; word must not be 0
+	template<typename Word>
+	size_t count_leading_zeros(Word word) {
+		static_assert(std::is_unsigned<Word>::value, "Word must be an unsigned integer type");
+		constexpr size_t word_bits = std::numeric_limits<Word>::digits;
+		assert(0 != word);
+#if defined(__GNUC__) || PREFIX_TABLE_HAS_BUILTIN(__builtin_clzll)
+		static_assert(word_bits <= std::numeric_limits<unsigned long long>::digits, "Word too large for __builtin_clzll");
+		return static_cast<size_t>(__builtin_clzll(word)) - (std::numeric_limits<unsigned long long>::digits - word_bits);
+#else
+		size_t length = 0;
+		for (Word bit = Word{1} << (word_bits - 1); 0 == (bit & word); bit >>= 1, ++length) ;
+		return length;
+#endif
+	}
+
+	// number of set bits in a native unsigned integer
+	template<typename Word>
+	size_t popcount(Word word) {
+		static_assert(std::is_unsigned<Word>::value, "Word must be an unsigned integer type");
+#if defined(__GNUC__) || PREFIX_TABLE_HAS_BUILTIN(__builtin_popcountll)
+		static_assert(std::numeric_limits<Word>::digits <= std::numeric_limits<unsigned long long>::digits, "Word too large for __builtin_popcountll");
+		return static_cast<size_t>(__builtin_popcountll(word));
+#else
+		size_t count = 0;
+		for (; 0 != word; word &= word - 1) ++count;
+		return count;
+#endif
+	}
+}
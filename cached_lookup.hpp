@@ -0,0 +1,91 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+// small 2-way set-associative cache of longest prefix match results in front of a table
+// (prefix_vector, radix_tree or frozen_radix_tree).
+//
+// entries store the value pointer returned by Table::value() (or the missing match) and are
+// tagged with the table generation; the table bumps its generation on every modification, which
+// invalidates all cached entries without touching the cache.
+//
+// not thread-safe: use one cached_lookup per thread (and share the table itself under the usual
+// readers/writer rules). meant for full length keys (addresses) with a skewed distribution.
+template<typename Table, typename Hash = std::hash<typename Table::key_t>, typename KeyEqual = std::equal_to<typename Table::key_t>>
+class cached_lookup {
+public:
+	typedef typename Table::key_t key_t;
+	typedef typename Table::value_t value_t;
+
+private:
+	struct entry {
+		key_t m_key{};
+		value_t const* m_value{nullptr};
+		// table generation + 1; 0 for unused entries
+		uint64_t m_tag{0};
+	};
+
+	struct set {
+		entry m_ways[2];
+		// index of the most recently used way
+		unsigned char m_mru{0};
+	};
+
+	Table const* m_table;
+	std::vector<set> m_sets;
+	size_t m_mask;
+	size_t m_hits{0};
+	size_t m_misses{0};
+
+	static size_t round_up_power_of_two(size_t n) {
+		size_t result = 1;
+		while (result < n) result <<= 1;
+		return result;
+	}
+
+public:
+	// number of sets is rounded up to a power of two; the cache holds 2 entries per set
+	explicit cached_lookup(Table const& table, size_t sets = 1024)
+	: m_table(&table), m_sets(round_up_power_of_two(sets)), m_mask(m_sets.size() - 1) {
+	}
+
+	// same result as Table::value(key), cached
+	value_t const* value(key_t const& key) {
+		uint64_t const tag = m_table->generation() + 1;
+		set& s = m_sets[Hash{}(key) & m_mask];
+		for (unsigned char way = 0; way < 2; ++way) {
+			entry& e = s.m_ways[way];
+			if (tag == e.m_tag && KeyEqual{}(e.m_key, key)) {
+				s.m_mru = way;
+				++m_hits;
+				return e.m_value;
+			}
+		}
+
+		++m_misses;
+		// replace the least recently used way
+		unsigned char const way = static_cast<unsigned char>(1 - s.m_mru);
+		entry& e = s.m_ways[way];
+		e.m_key = key;
+		e.m_value = m_table->value(key);
+		e.m_tag = tag;
+		s.m_mru = way;
+		return e.m_value;
+	}
+
+	Table const& table() const {
+		return *m_table;
+	}
+
+	// drop all entries (not needed after table modifications)
+	void clear() {
+		for (auto& s: m_sets) s = set{};
+	}
+
+	size_t hits() const { return m_hits; }
+	size_t misses() const { return m_misses; }
+};
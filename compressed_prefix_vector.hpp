@@ -0,0 +1,278 @@
+#pragma once
+
+#include "bigendian_bitstring.hpp"
+#include "bitstring.hpp"
+#include "instrumentation.hpp"
+#include "prefix_vector.hpp"
+#include "table_generation.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <cassert>
+
+#include <stddef.h>
+#include <stdint.h>
+
+// immutable, compressed copy of a prefix_vector with bigendian::bitstring keys (long keys
+// like IPv6 prefixes or label paths, where neighbouring keys share most of their bytes).
+//
+// keys are stored front coded in blocks of `BlockSize`: the first key of a block is stored in
+// full, every following key as the number of leading bytes it shares with the previous key
+// plus its remaining bytes. the key lengths and ancestor indices (see prefix_vector) are kept
+// in parallel arrays, values in a separate array.
+//
+// a lookup binary searches the first keys of the blocks, decodes one block up to the lower
+// bound and then follows the ancestors by their key lengths only: all ancestors of an entry
+// are prefixes of its key, so no other key needs to be decoded.
+template<typename Key, typename Value, typename KeyBitStringTraits, unsigned BlockSize = 16>
+class compressed_prefix_vector {
+	static_assert(std::is_same<typename KeyBitStringTraits::bitstring, bigendian::bitstring>::value, "compressed_prefix_vector needs bigendian::bitstring keys");
+	static_assert(BlockSize > 0, "BlockSize must not be 0");
+
+public:
+	typedef Key key_t;
+	typedef Value value_t;
+	typedef bigendian::bitstring bitstring;
+	typedef uint32_t index_t;
+
+	static constexpr index_t NO_ANCESTOR{~index_t{0}};
+	// longest supported key (shared byte counts are stored in a single byte)
+	static constexpr size_t MAX_KEY_BYTES{255};
+
+private:
+	// per block: offset of its first key in m_bytes
+	std::vector<uint32_t> m_blocks;
+	// per key: number of bytes shared with the previous key, followed by the remaining bytes
+	std::vector<unsigned char> m_bytes;
+	// per key: length in bits
+	std::vector<uint16_t> m_lengths;
+	// per key: index of the entry with the longest key which is a prefix of this key
+	std::vector<index_t> m_ancestors;
+	std::vector<value_t> m_values;
+	// only changes through assignment and swap
+	table_generation m_generation;
+
+	static size_t key_bytes(size_t length) {
+		return (length + 7) / 8;
+	}
+
+	// first key of a block (stored in full)
+	bitstring block_key(size_t block) const {
+		return bitstring(m_bytes.data() + m_blocks[block] + 1, m_lengths[block * BlockSize]);
+	}
+
+	// decode the key at ndx (stored at offset in m_bytes) into buf, given the bytes of the
+	// previous key in prev (may be buf itself); returns the offset of the following key
+	size_t decode(size_t ndx, size_t offset, unsigned char const* prev, unsigned char* buf) const {
+		size_t const shared = m_bytes[offset];
+		size_t const tail = key_bytes(m_lengths[ndx]) - shared;
+		if (buf != prev) std::memcpy(buf, prev, shared);
+		std::memcpy(buf + shared, m_bytes.data() + offset + 1, tail);
+		return offset + 1 + tail;
+	}
+
+	// index of the first entry with a key not less than k (or size()); sets exact if that key
+	// equals k, and prev_lcp to the length of the longest common prefix of k and the key
+	// before it (if there is one)
+	size_t lower_bound(bitstring const& k, bool& exact, size_t& prev_lcp) const {
+		exact = false;
+		prev_lcp = 0;
+		// first block with a first key not less than k
+		size_t lo = 0, hi = m_blocks.size();
+		while (lo < hi) {
+			size_t const mid = lo + (hi - lo) / 2;
+			PREFIX_TABLE_COUNT(key_compares, 1);
+			if (is_lexicographic_less(block_key(mid), k)) {
+				lo = mid + 1;
+			} else {
+				hi = mid;
+			}
+		}
+		if (0 == lo) {
+			exact = !m_blocks.empty() && block_key(0) == k;
+			return 0;
+		}
+
+		// scan the block before it; its first key is less than k
+		size_t const block = lo - 1;
+		size_t const first = block * BlockSize;
+		size_t const last = std::min(first + BlockSize, m_values.size());
+		unsigned char buf[2][MAX_KEY_BYTES];
+		bitstring prev = block_key(block);
+		unsigned char const* prev_bytes = prev.byte_data();
+		size_t offset = m_blocks[block] + 1 + key_bytes(prev.length());
+		for (size_t ndx = first + 1; ndx < last; ++ndx) {
+			unsigned char* const cur_bytes = buf[ndx % 2];
+			offset = decode(ndx, offset, prev_bytes, cur_bytes);
+			bitstring const cur(cur_bytes, m_lengths[ndx]);
+			PREFIX_TABLE_COUNT(key_compares, 1);
+			if (!is_lexicographic_less(cur, k)) {
+				exact = (cur == k);
+				if (!exact) prev_lcp = longest_common_prefix(prev, k).length();
+				return ndx;
+			}
+			prev = cur;
+			prev_bytes = cur_bytes;
+		}
+		exact = (lo < m_blocks.size() && block_key(lo) == k);
+		if (!exact) prev_lcp = longest_common_prefix(prev, k).length();
+		return last;
+	}
+
+	// entry with the longest key which is a prefix of k (or NO_ANCESTOR)
+	index_t lookup(bitstring const& k) const {
+		PREFIX_TABLE_COUNT(vector_lookups, 1);
+		bool exact;
+		size_t lcp;
+		size_t const pos = lower_bound(k, exact, lcp);
+		if (exact) return static_cast<index_t>(pos);
+		if (0 == pos) return NO_ANCESTOR;
+		// the entry before pos and its ancestors are the only candidates; they are all
+		// prefixes of the key before pos, so they match k iff they are not longer than lcp
+		index_t current = static_cast<index_t>(pos - 1);
+		while (NO_ANCESTOR != current && m_lengths[current] > lcp) {
+			PREFIX_TABLE_COUNT(ancestor_hops, 1);
+			assert(NO_ANCESTOR == m_ancestors[current] || m_ancestors[current] < current);
+			current = m_ancestors[current];
+		}
+		return current;
+	}
+
+	index_t lookup_exact(bitstring const& k) const {
+		PREFIX_TABLE_COUNT(vector_lookups, 1);
+		bool exact;
+		size_t lcp;
+		size_t const pos = lower_bound(k, exact, lcp);
+		return exact ? static_cast<index_t>(pos) : NO_ANCESTOR;
+	}
+
+	value_t const* to_value(index_t ndx) const {
+		return (NO_ANCESTOR == ndx) ? nullptr : &m_values[ndx];
+	}
+
+	static bitstring key_to_bs(key_t const& key) {
+		KeyBitStringTraits traits{};
+		return traits.value_to_bitstring(key);
+	}
+
+public:
+	compressed_prefix_vector() = default;
+
+	// compressed copy of the given table
+	template<typename Allocator>
+	explicit compressed_prefix_vector(prefix_vector<Key, Value, KeyBitStringTraits, Allocator> const& source) {
+		if (source.size() >= NO_ANCESTOR) throw std::length_error("compressed_prefix_vector: too many entries");
+		m_blocks.reserve((source.size() + BlockSize - 1) / BlockSize);
+		m_lengths.reserve(source.size());
+		m_ancestors.reserve(source.size());
+		m_values.reserve(source.size());
+
+		unsigned char buf[2][MAX_KEY_BYTES];
+		size_t prev_size = 0;
+		// current chain of ancestors (keys point into source)
+		std::vector<std::pair<index_t, bitstring>> ancestors;
+		for (auto const& elem: source) {
+			bitstring const k = key_to_bs(elem.key());
+			size_t const size = key_bytes(k.length());
+			if (size > MAX_KEY_BYTES) throw std::length_error("compressed_prefix_vector: key too long");
+			index_t const ndx = static_cast<index_t>(m_values.size());
+			unsigned char* const cur = buf[ndx % 2];
+			unsigned char const* const prev = buf[(ndx + 1) % 2];
+			// copy with unused bits cleared, so equal bytes mean equal bits
+			k.set_bitstring(cur, size);
+
+			size_t shared = 0;
+			if (0 == ndx % BlockSize) {
+				if (m_bytes.size() > std::numeric_limits<uint32_t>::max()) throw std::length_error("compressed_prefix_vector: too many key bytes");
+				m_blocks.push_back(static_cast<uint32_t>(m_bytes.size()));
+			} else {
+				size_t const limit = std::min(size, prev_size);
+				while (shared < limit && cur[shared] == prev[shared]) ++shared;
+			}
+			m_bytes.push_back(static_cast<unsigned char>(shared));
+			m_bytes.insert(m_bytes.end(), cur + shared, cur + size);
+			prev_size = size;
+
+			while (!ancestors.empty() && !is_prefix(ancestors.back().second, k)) ancestors.pop_back();
+			m_ancestors.push_back(ancestors.empty() ? NO_ANCESTOR : ancestors.back().first);
+			ancestors.emplace_back(ndx, k);
+			m_lengths.push_back(static_cast<uint16_t>(k.length()));
+			m_values.push_back(elem.value());
+		}
+		m_bytes.shrink_to_fit();
+	}
+
+	// value from entry with longest matching prefix of key or nullptr
+	value_t const* value(key_t const& key) const {
+		return to_value(lookup(key_to_bs(key)));
+	}
+
+	// same by address (see KeyBitStringTraits::address_to_bitstring in bitstring.hpp)
+	template<typename Address, typename = decltype(traits_address_to_bitstring<KeyBitStringTraits>(std::declval<Address const&>()))>
+	value_t const* value(Address const& address) const {
+		return to_value(lookup(traits_address_to_bitstring<KeyBitStringTraits>(address)));
+	}
+
+	// value from entry with key equal to given key or nullptr
+	value_t const* value_exact(key_t const& key) const {
+		return to_value(lookup_exact(key_to_bs(key)));
+	}
+
+	// calls `f(key, value)` for all entries (in prefix_vector order)
+	template<typename Function>
+	void for_each(Function&& f) const {
+		KeyBitStringTraits traits{};
+		unsigned char buf[MAX_KEY_BYTES];
+		size_t offset = 0;
+		for (size_t ndx = 0; ndx < m_values.size(); ++ndx) {
+			// decoding in place: the shared bytes are already in buf
+			offset = decode(ndx, offset, buf, buf);
+			f(traits.bitstring_to_value(bitstring(buf, m_lengths[ndx])), m_values[ndx]);
+		}
+	}
+
+	bool empty() const {
+		return m_values.empty();
+	}
+
+	size_t size() const {
+		return m_values.size();
+	}
+
+	// bytes allocated for the encoded keys, including lengths, ancestors and block offsets
+	size_t key_memory_usage() const {
+		return m_blocks.capacity() * sizeof(uint32_t) + m_bytes.capacity() + m_lengths.capacity() * sizeof(uint16_t) + m_ancestors.capacity() * sizeof(index_t);
+	}
+
+	// bytes allocated for the table itself (not counting memory owned by values)
+	size_t memory_usage() const {
+		return sizeof(*this) + key_memory_usage() + m_values.capacity() * sizeof(value_t);
+	}
+
+	// see prefix_vector::generation()
+	uint64_t generation() const {
+		return m_generation.value();
+	}
+
+	friend void swap(compressed_prefix_vector& a, compressed_prefix_vector& b) {
+		using std::swap;
+		swap(a.m_blocks, b.m_blocks);
+		swap(a.m_bytes, b.m_bytes);
+		swap(a.m_lengths, b.m_lengths);
+		swap(a.m_ancestors, b.m_ancestors);
+		swap(a.m_values, b.m_values);
+		swap(a.m_generation, b.m_generation);
+	}
+};
+
+template<typename Key, typename Value, typename KeyBitStringTraits, unsigned BlockSize>
+constexpr typename compressed_prefix_vector<Key, Value, KeyBitStringTraits, BlockSize>::index_t compressed_prefix_vector<Key, Value, KeyBitStringTraits, BlockSize>::NO_ANCESTOR;
+
+template<typename Key, typename Value, typename KeyBitStringTraits, unsigned BlockSize>
+constexpr size_t compressed_prefix_vector<Key, Value, KeyBitStringTraits, BlockSize>::MAX_KEY_BYTES;
@@ -0,0 +1,125 @@
+#pragma once
+
+#include "ip_network.hpp"
+#include "prefix_vector.hpp"
+
+#include <utility>
+
+#include <stddef.h>
+
+// one table for both address families: holds a table specialized for ipv4_network keys
+// and one for ipv6_network keys, and dispatches on the family of the ip_network argument.
+// `IPv4Table` and `IPv6Table` can be any prefix_vector or radix_tree instantiation.
+template<
+	typename Value,
+	typename IPv4Table = prefix_vector<ipv4_network, Value, ipv4_network_bitstring_traits>,
+	typename IPv6Table = prefix_vector<ipv6_network, Value, ipv6_network_bitstring_traits>>
+class dual_stack_table {
+public:
+	typedef ip_network key_t;
+	typedef Value value_t;
+	typedef IPv4Table ipv4_table_t;
+	typedef IPv6Table ipv6_table_t;
+
+	struct statistics_t {
+		size_t ipv4_size{0};
+		size_t ipv6_size{0};
+		size_t ipv4_memory_usage{0};
+		size_t ipv6_memory_usage{0};
+	};
+
+private:
+	ipv4_table_t m_ipv4;
+	ipv6_table_t m_ipv6;
+
+public:
+	// access to the per-family tables (e.g. for iterator based lookups)
+	ipv4_table_t& ipv4() { return m_ipv4; }
+	ipv4_table_t const& ipv4() const { return m_ipv4; }
+	ipv6_table_t& ipv6() { return m_ipv6; }
+	ipv6_table_t const& ipv6() const { return m_ipv6; }
+
+	// value from entry with longest matching prefix of key or nullptr
+	value_t const* value(key_t const& key) const {
+		return key.is_ipv6() ? m_ipv6.value(key.ipv6()) : m_ipv4.value(key.ipv4());
+	}
+
+	value_t* value(key_t const& key) {
+		return key.is_ipv6() ? m_ipv6.value(key.ipv6()) : m_ipv4.value(key.ipv4());
+	}
+
+	// batched value(): stores value(*(first + i)) in *(out + i)
+	// handles all ipv4 keys first and then all ipv6 keys, so each pass stays in one table
+	template<typename RandomAccessIterator, typename RandomAccessOutputIterator>
+	void values(RandomAccessIterator first, RandomAccessIterator last, RandomAccessOutputIterator out) const {
+		for (RandomAccessIterator it = first; it != last; ++it) {
+			if (it->is_ipv4()) out[it - first] = m_ipv4.value(it->ipv4());
+		}
+		for (RandomAccessIterator it = first; it != last; ++it) {
+			if (it->is_ipv6()) out[it - first] = m_ipv6.value(it->ipv6());
+		}
+	}
+
+	// insert, but don't overwrite existing entry (returns false if key is already present)
+	template<typename ValueArg>
+	bool insert(key_t const& key, ValueArg&& value) {
+		if (key.is_ipv6()) return m_ipv6.insert(key.ipv6(), std::forward<ValueArg>(value)).second;
+		return m_ipv4.insert(key.ipv4(), std::forward<ValueArg>(value)).second;
+	}
+
+	// insert, or assign if key is already present
+	template<typename ValueArg>
+	void insert_or_assign(key_t const& key, ValueArg&& value) {
+		if (key.is_ipv6()) {
+			m_ipv6.insert_or_assign(key.ipv6(), std::forward<ValueArg>(value));
+		} else {
+			m_ipv4.insert_or_assign(key.ipv4(), std::forward<ValueArg>(value));
+		}
+	}
+
+	// erase element with given key. returns how many elements were deleted (0 or 1)
+	size_t erase(key_t const& key) {
+		return key.is_ipv6() ? m_ipv6.erase(key.ipv6()) : m_ipv4.erase(key.ipv4());
+	}
+
+	// calls `f(ip_network, value)` for all entries; first ipv4, then ipv6
+	template<typename Function>
+	void for_each(Function&& f) const {
+		for (auto const& elem: m_ipv4) f(key_t(elem.key()), elem.value());
+		for (auto const& elem: m_ipv6) f(key_t(elem.key()), elem.value());
+	}
+
+	template<typename Function>
+	void for_each(Function&& f) {
+		for (auto& elem: m_ipv4) f(key_t(elem.key()), elem.value());
+		for (auto& elem: m_ipv6) f(key_t(elem.key()), elem.value());
+	}
+
+	// independent copy of the current content
+	dual_stack_table snapshot() const {
+		return *this;
+	}
+
+	statistics_t statistics() const {
+		statistics_t result;
+		result.ipv4_size = m_ipv4.size();
+		result.ipv6_size = m_ipv6.size();
+		result.ipv4_memory_usage = m_ipv4.memory_usage();
+		result.ipv6_memory_usage = m_ipv6.memory_usage();
+		return result;
+	}
+
+	bool empty() const {
+		return m_ipv4.empty() && m_ipv6.empty();
+	}
+
+	size_t size() const {
+		return m_ipv4.size() + m_ipv6.size();
+	}
+
+	friend void swap(dual_stack_table& a, dual_stack_table& b) {
+		using std::swap;
+		swap(a.m_ipv4, b.m_ipv4);
+		swap(a.m_ipv6, b.m_ipv6);
+	}
+};
@@ -0,0 +1,204 @@
+#pragma once
+
+#include "builtins.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <string>
+#include <type_traits>
+
+#include <stddef.h>
+#include <stdint.h>
+
+// prefix of a `Width`-bit key stored in the low bits of the native unsigned integer `Word`, e.g.
+// fixed_prefix<48, uint64_t> for MAC addresses or fixed_prefix<20, uint32_t> for MPLS labels.
+// the first bit of the key is bit (Width - 1) of the native word.
+template<unsigned int Width, typename Word>
+class fixed_prefix {
+	static_assert(std::is_unsigned<Word>::value, "Word must be an unsigned integer type");
+	static_assert(Width > 0 && Width <= std::numeric_limits<Word>::digits, "Width doesn't fit into Word");
+	static_assert(Width <= std::numeric_limits<unsigned char>::max(), "Width doesn't fit into length type");
+
+public:
+	typedef Word word_t;
+	typedef unsigned char length_t;
+
+	static constexpr length_t width{Width};
+
+private:
+	struct mask_table {
+		// netmask[l]: the first l bits of the key set
+		Word netmask[Width + 1];
+
+		constexpr mask_table()
+		: netmask() {
+			for (unsigned int l = 1; l <= Width; ++l) {
+				netmask[l] = static_cast<Word>(netmask[l - 1] | (Word{1} << (Width - l)));
+			}
+		}
+	};
+	static constexpr mask_table s_masks{};
+
+	// always clean, i.e. contains no bits outside the netmask.
+	Word m_address{0};
+	length_t m_length{0};
+
+public:
+	static constexpr Word netmask(length_t length) {
+		return s_masks.netmask[length < Width ? length : Width];
+	}
+
+	static constexpr Word hostmask(length_t length) {
+		return static_cast<Word>(s_masks.netmask[Width] ^ netmask(length));
+	}
+
+	constexpr fixed_prefix() = default;
+	explicit constexpr fixed_prefix(Word address, length_t length)
+	: m_address(static_cast<Word>(address & netmask(length))), m_length(std::min<length_t>(length, Width)) {
+	}
+	explicit constexpr fixed_prefix(Word address)
+	: m_address(static_cast<Word>(address & netmask(Width))), m_length(Width) {
+	}
+
+	constexpr Word address() const { return m_address; }
+	constexpr length_t length() const { return m_length; }
+};
+
+template<unsigned int Width, typename Word>
+constexpr typename fixed_prefix<Width, Word>::length_t fixed_prefix<Width, Word>::width;
+
+template<unsigned int Width, typename Word>
+constexpr typename fixed_prefix<Width, Word>::mask_table fixed_prefix<Width, Word>::s_masks;
+
+template<unsigned int Width, typename Word>
+bool operator==(fixed_prefix<Width, Word> a, fixed_prefix<Width, Word> b) {
+	return a.address() == b.address() && a.length() == b.length();
+}
+
+template<unsigned int Width, typename Word>
+bool operator!=(fixed_prefix<Width, Word> a, fixed_prefix<Width, Word> b) {
+	return !(a == b);
+}
+
+namespace std {
+	template<unsigned int Width, typename Word>
+	struct hash<fixed_prefix<Width, Word>> {
+		size_t operator()(fixed_prefix<Width, Word> value) const {
+			static_assert(Width <= 64, "hash only uses 64 bits of the address");
+			uint64_t const h = (uint64_t{value.address()} ^ (uint64_t{value.length()} << 56)) * UINT64_C(0x9e3779b97f4a7c15);
+			return static_cast<size_t>(h ^ (h >> 32));
+		}
+	};
+}
+
+// hex digits of the address, followed by "/length"
+template<unsigned int Width, typename Word>
+std::string to_string(fixed_prefix<Width, Word> value) {
+	static char const hex_digits[] = "0123456789abcdef";
+	std::string result(2 + (Width + 3) / 4, '0');
+	result[1] = 'x';
+	Word address = value.address();
+	for (size_t i = result.size(); i-- > 2; address = static_cast<Word>(address >> 4)) {
+		result[i] = hex_digits[address & 0xfu];
+	}
+	result += '/';
+	result += std::to_string(unsigned{value.length()});
+	return result;
+}
+
+template<unsigned int Width, typename Word>
+struct fixed_prefix_bitstring {
+	typedef fixed_prefix<Width, Word> prefix_t;
+
+	prefix_t value{};
+
+	fixed_prefix_bitstring() = default;
+	explicit fixed_prefix_bitstring(prefix_t val)
+	: value(val) {
+	}
+
+	size_t length() const { return value.length(); }
+
+	fixed_prefix_bitstring truncate(size_t length) const {
+		typename prefix_t::length_t new_length = static_cast<typename prefix_t::length_t>(std::min<size_t>(length, value.length()));
+		return fixed_prefix_bitstring(prefix_t(value.address(), new_length));
+	}
+
+	bool operator[](size_t ndx) const {
+		Word const mask = static_cast<Word>(Word{1} << (Width - 1u - (ndx % Width)));
+		return 0 != (value.address() & mask);
+	}
+};
+
+template<unsigned int Width, typename Word>
+bool operator==(fixed_prefix_bitstring<Width, Word> const& a, fixed_prefix_bitstring<Width, Word> const& b) {
+	return a.value.length() == b.value.length() && a.value.address() == b.value.address();
+}
+
+template<unsigned int Width, typename Word>
+bool operator!=(fixed_prefix_bitstring<Width, Word> const& a, fixed_prefix_bitstring<Width, Word> const& b) {
+	return !(a == b);
+}
+
+template<unsigned int Width, typename Word>
+bool is_lexicographic_less(fixed_prefix_bitstring<Width, Word> const& a, fixed_prefix_bitstring<Width, Word> const& b) {
+	if (a.value.address() == b.value.address()) {
+		// one is prefix of the other; shorter comes first
+		return a.value.length() < b.value.length();
+	}
+	// only the smaller one can be a "real" prefix of the other
+	return a.value.address() < b.value.address();
+}
+
+template<unsigned int Width, typename Word>
+bool is_tree_less(fixed_prefix_bitstring<Width, Word> const& a, fixed_prefix_bitstring<Width, Word> const& b) {
+	typedef fixed_prefix<Width, Word> prefix_t;
+	typename prefix_t::length_t const trunc_len = std::min(a.value.length(), b.value.length());
+	Word const truncate_mask = prefix_t::netmask(trunc_len);
+	Word const a_trunc = truncate_mask & a.value.address();
+	Word const b_trunc = truncate_mask & b.value.address();
+	if (a_trunc != b_trunc) return a_trunc < b_trunc;
+	// one is prefix of the other
+	if (a.value.length() == b.value.length()) return false; // a == b
+	if (a.value.length() < b.value.length()) { // a prefix of b: a is smaller if b continues with 1
+		return b[trunc_len];
+	} else { // b prefix of a: a is smaller if it continues with 0
+		return !a[trunc_len];
+	}
+}
+
+template<unsigned int Width, typename Word>
+bool is_prefix(fixed_prefix_bitstring<Width, Word> const& prefix, fixed_prefix_bitstring<Width, Word> const& str) {
+	typedef fixed_prefix<Width, Word> prefix_t;
+	if (prefix.value.length() > str.value.length()) return false;
+	return prefix.value.address() == (str.value.address() & prefix_t::netmask(prefix.value.length()));
+}
+
+template<unsigned int Width, typename Word>
+fixed_prefix_bitstring<Width, Word> longest_common_prefix(fixed_prefix_bitstring<Width, Word> const& a, fixed_prefix_bitstring<Width, Word> const& b) {
+	typedef fixed_prefix<Width, Word> prefix_t;
+	Word const uncommon_bits = static_cast<Word>((a.value.address() ^ b.value.address()) | prefix_t::hostmask(std::min(a.value.length(), b.value.length())));
+	if (0 == uncommon_bits) return a; // equal full length keys
+	size_t const length = builtins_detail::count_leading_zeros(uncommon_bits) - (std::numeric_limits<Word>::digits - Width);
+	return a.truncate(length);
+}
+
+template<unsigned int Width, typename Word>
+struct fixed_prefix_bitstring_traits {
+	typedef fixed_prefix_bitstring<Width, Word> bitstring;
+	typedef fixed_prefix<Width, Word> value_type;
+
+	bitstring value_to_bitstring(value_type val) {
+		return bitstring(val);
+	}
+
+	value_type bitstring_to_value(bitstring bs) {
+		return bs.value;
+	}
+
+	// full length bitstring for lookups by address
+	bitstring address_to_bitstring(Word address) {
+		return bitstring(value_type(address));
+	}
+};
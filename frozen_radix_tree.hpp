@@ -0,0 +1,391 @@
+#pragma once
+
+#include "bitstring.hpp"
+#include "table_generation.hpp"
+
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <cassert>
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <boost/iterator/iterator_facade.hpp>
+#include <boost/range/iterator_range.hpp>
+
+template<typename Key, typename Value, typename KeyBitStringTraits, typename Allocator>
+class radix_tree;
+
+// immutable, pointer-free copy of a radix_tree (see radix_tree::freeze()).
+// all nodes are stored in a single array in plain breadth-first order: the top levels of the
+// tree, which every lookup walks through, end up next to each other in a few cache lines.
+// this is not a van Emde Boas or cache-line blocked layout: below the top levels every step
+// of a lookup still lands on a different cache line.
+// links are 32-bit indices into the node array; values are stored in a separate array.
+template<typename Key, typename Value, typename KeyBitStringTraits>
+class frozen_radix_tree
+{
+public:
+	typedef Key key_t;
+	typedef Value value_t;
+	typedef uint32_t index_t;
+
+	static constexpr index_t NO_INDEX{~index_t{0}};
+
+private:
+	struct inner_node {
+		key_t m_key{};
+		index_t m_left{NO_INDEX};
+		index_t m_right{NO_INDEX};
+		index_t m_parent{NO_INDEX};
+		// index into m_values (or NO_INDEX)
+		index_t m_value{NO_INDEX};
+	};
+
+	std::vector<inner_node> m_nodes;
+	std::vector<value_t> m_values;
+	// only changes through assignment and swap
+	table_generation m_generation;
+
+public:
+	class const_iterator;
+	class const_covering_iterator;
+
+	class element_type {
+	private:
+		friend class frozen_radix_tree;
+		friend class const_iterator;
+		friend class const_covering_iterator;
+
+		frozen_radix_tree const* m_tree{nullptr};
+		index_t m_node{NO_INDEX};
+
+		explicit element_type(frozen_radix_tree const* tree, index_t node)
+		: m_tree(tree), m_node(node) {
+		}
+
+		inner_node const& get() const { return m_tree->m_nodes[m_node]; }
+
+	public:
+		element_type() = default;
+
+		key_t const& key() const { return get().m_key; }
+
+		// user should only ever see nodes with value
+		value_t const& value() const { return m_tree->m_values[get().m_value]; }
+	};
+
+	class const_iterator : public boost::iterator_facade<const_iterator, element_type const, boost::forward_traversal_tag> {
+	public:
+		const_iterator() = default;
+
+		boost::iterator_range<const_iterator> subtree() const {
+			return boost::make_iterator_range(
+				const_iterator(m_elem.m_tree, m_elem.m_node, m_elem.m_node, no_init_walk{}),
+				const_iterator(m_elem.m_tree, NO_INDEX, m_elem.m_node, no_init_walk{}));
+		}
+
+		explicit operator bool() const {
+			return NO_INDEX != m_elem.m_node;
+		}
+
+	private:
+		friend class frozen_radix_tree;
+		friend class boost::iterator_core_access;
+
+		element_type m_elem;
+		index_t m_root{NO_INDEX}; // can limit to subtree
+
+		explicit const_iterator(frozen_radix_tree const* tree, index_t pos, index_t root)
+		: m_elem(tree, pos), m_root(root) {
+			// find first node with value
+			if (NO_INDEX != pos && NO_INDEX == node(pos).m_value) increment();
+		}
+
+		struct no_init_walk{};
+		explicit const_iterator(frozen_radix_tree const* tree, index_t pos, index_t root, no_init_walk)
+		: m_elem(tree, pos), m_root(root) {
+		}
+
+		inner_node const& node(index_t ndx) const { return m_elem.m_tree->m_nodes[ndx]; }
+
+		void increment() {
+			index_t& current = m_elem.m_node;
+			for (;;) {
+				if (NO_INDEX != node(current).m_left) {
+					current = node(current).m_left;
+				} else if (NO_INDEX != node(current).m_right) {
+					current = node(current).m_right;
+				} else {
+					// reached bottom. go up again
+					for (;;) {
+						index_t const prev = current;
+						if (m_root == current) {
+							current = NO_INDEX;
+							return; // reached end of tree
+						}
+						current = node(current).m_parent;
+						// previous node wasn't root, so there must have been a parent
+						assert(NO_INDEX != current);
+						// when we walk up and came through the left link, and the right link has a node,
+						// walk down the right link
+						if (node(current).m_left == prev && NO_INDEX != node(current).m_right) {
+							current = node(current).m_right;
+							break;
+						}
+						// otherwise keep walking up
+					}
+				}
+				// found a node with value, return it
+				if (NO_INDEX != node(current).m_value) return;
+			}
+		}
+
+		bool equal(const_iterator const& other) const {
+			return m_elem.m_node == other.m_elem.m_node;
+		}
+
+		element_type const& dereference() const { return m_elem; }
+	};
+
+	typedef const_iterator iterator;
+
+	// walks from a node up to the root, visiting only nodes with value
+	class const_covering_iterator : public boost::iterator_facade<const_covering_iterator, element_type const, boost::forward_traversal_tag> {
+	public:
+		const_covering_iterator() = default;
+
+	private:
+		friend class frozen_radix_tree;
+		friend class boost::iterator_core_access;
+
+		element_type m_elem;
+
+		// pos must be a node with value (or NO_INDEX)
+		explicit const_covering_iterator(frozen_radix_tree const* tree, index_t pos)
+		: m_elem(tree, pos) {
+			assert(NO_INDEX == pos || NO_INDEX != m_elem.get().m_value);
+		}
+
+		void increment() {
+			do {
+				m_elem.m_node = m_elem.get().m_parent;
+			} while (NO_INDEX != m_elem.m_node && NO_INDEX == m_elem.get().m_value);
+		}
+
+		bool equal(const_covering_iterator const& other) const {
+			return m_elem.m_node == other.m_elem.m_node;
+		}
+
+		element_type const& dereference() const { return m_elem; }
+	};
+
+	typedef const_covering_iterator covering_iterator;
+
+private:
+	template<typename, typename, typename, typename>
+	friend class radix_tree;
+
+	typedef typename KeyBitStringTraits::bitstring bitstring;
+	static bitstring key_to_bs(key_t const& key) {
+		KeyBitStringTraits keyBitStringTraits{};
+		return keyBitStringTraits.value_to_bitstring(key);
+	}
+
+	// build from the root node of a radix_tree
+	template<typename Node>
+	explicit frozen_radix_tree(Node const* root) {
+		// collect the nodes in breadth-first order first, so both arrays can be allocated
+		// with their final size: (source node, index of parent in m_nodes)
+		std::vector<std::pair<Node const*, index_t>> queue;
+		size_t value_count = 0;
+		if (root) queue.emplace_back(root, NO_INDEX);
+		for (size_t i = 0; i < queue.size(); ++i) {
+			Node const* const n = queue[i].first;
+			index_t const ndx = next_index(i);
+			if (n->m_value) ++value_count;
+			if (n->m_left) queue.emplace_back(n->m_left, ndx);
+			if (n->m_right) queue.emplace_back(n->m_right, ndx);
+		}
+		next_index(queue.size());
+		m_nodes.reserve(queue.size());
+		m_values.reserve(value_count);
+
+		// children were queued in the same order: left before right, node by node
+		index_t next_child = 1;
+		for (auto const& entry: queue) {
+			Node const* const n = entry.first;
+			inner_node elem;
+			elem.m_key = n->m_key;
+			elem.m_parent = entry.second;
+			if (n->m_value) {
+				elem.m_value = static_cast<index_t>(m_values.size());
+				m_values.push_back(*n->m_value);
+			}
+			if (n->m_left) elem.m_left = next_child++;
+			if (n->m_right) elem.m_right = next_child++;
+			m_nodes.push_back(std::move(elem));
+		}
+	}
+
+	static index_t next_index(size_t count) {
+		if (count >= NO_INDEX) throw std::length_error("frozen_radix_tree: too many nodes");
+		return static_cast<index_t>(count);
+	}
+
+	index_t root() const {
+		return m_nodes.empty() ? NO_INDEX : 0;
+	}
+
+	// same as radix_tree::intern_lookup_parent
+	index_t intern_lookup_parent(bitstring const& key_bs) const {
+		index_t current = root();
+
+		for (;;) {
+			if (NO_INDEX == current) return NO_INDEX;
+			inner_node const& n = m_nodes[current];
+			bitstring const parent_key_bs = key_to_bs(n.m_key);
+			if (is_prefix(parent_key_bs, key_bs)) {
+				if (parent_key_bs == key_bs) {
+					// found an exact match
+					return current;
+				}
+				assert(key_bs.length() > parent_key_bs.length());
+				current = key_bs[parent_key_bs.length()] ? n.m_right : n.m_left;
+			} else if (is_prefix(key_bs, parent_key_bs)) {
+				// first node which has a key prefixed by key_bs
+				return current;
+			} else {
+				return NO_INDEX;
+			}
+		}
+	}
+
+	// same as radix_tree::intern_lookup
+	index_t intern_lookup(bitstring const& key_bs) const {
+		index_t last_value_node = NO_INDEX;
+		index_t current = root();
+
+		for (;;) {
+			if (NO_INDEX == current) return last_value_node;
+			inner_node const& n = m_nodes[current];
+			bitstring const parent_key_bs = key_to_bs(n.m_key);
+			if (is_prefix(parent_key_bs, key_bs)) {
+				if (NO_INDEX != n.m_value) last_value_node = current;
+				if (parent_key_bs == key_bs) {
+					// found an exact match
+					return last_value_node;
+				}
+				assert(key_bs.length() > parent_key_bs.length());
+				current = key_bs[parent_key_bs.length()] ? n.m_right : n.m_left;
+			} else {
+				return last_value_node;
+			}
+		}
+	}
+
+	// same as radix_tree::intern_exact_lookup
+	index_t intern_exact_lookup(bitstring const& key_bs) const {
+		index_t current = root();
+
+		for (;;) {
+			if (NO_INDEX == current) return NO_INDEX;
+			inner_node const& n = m_nodes[current];
+			bitstring const parent_key_bs = key_to_bs(n.m_key);
+			if (is_prefix(parent_key_bs, key_bs)) {
+				if (parent_key_bs == key_bs) {
+					// found an exact match; check whether it has a value
+					return NO_INDEX != n.m_value ? current : NO_INDEX;
+				}
+				assert(key_bs.length() > parent_key_bs.length());
+				current = key_bs[parent_key_bs.length()] ? n.m_right : n.m_left;
+			} else {
+				return NO_INDEX;
+			}
+		}
+	}
+
+public:
+	frozen_radix_tree() = default;
+
+	const_iterator find(key_t const& key) const {
+		return const_iterator(this, intern_lookup(key_to_bs(key)), root());
+	}
+
+	const_iterator find_exact(key_t const& key) const {
+		return const_iterator(this, intern_exact_lookup(key_to_bs(key)), root());
+	}
+
+	boost::iterator_range<const_iterator> find_all(key_t const& key) const {
+		index_t const n = intern_lookup_parent(key_to_bs(key));
+		return boost::make_iterator_range(const_iterator(this, n, n), const_iterator(this, NO_INDEX, n));
+	}
+
+	// all entries with a key that is a prefix of the given key, from the longest to the shortest key
+	boost::iterator_range<const_covering_iterator> covering(key_t const& key) const {
+		return boost::make_iterator_range(const_covering_iterator(this, intern_lookup(key_to_bs(key))), const_covering_iterator(this, NO_INDEX));
+	}
+
+	const value_t* value(key_t const& key) const {
+		index_t const n = intern_lookup(key_to_bs(key));
+		return NO_INDEX != n ? &m_values[m_nodes[n].m_value] : nullptr;
+	}
+
+	// find(), find_exact() and value() by address or bitstring, see radix_tree
+	template<typename Address, typename = decltype(traits_address_to_bitstring<KeyBitStringTraits>(std::declval<Address const&>()))>
+	const_iterator find(Address const& address) const {
+		return const_iterator(this, intern_lookup(traits_address_to_bitstring<KeyBitStringTraits>(address)), root());
+	}
+
+	template<typename Address, typename = decltype(traits_address_to_bitstring<KeyBitStringTraits>(std::declval<Address const&>()))>
+	const_iterator find_exact(Address const& address) const {
+		return const_iterator(this, intern_exact_lookup(traits_address_to_bitstring<KeyBitStringTraits>(address)), root());
+	}
+
+	template<typename Address, typename = decltype(traits_address_to_bitstring<KeyBitStringTraits>(std::declval<Address const&>()))>
+	const value_t* value(Address const& address) const {
+		index_t const n = intern_lookup(traits_address_to_bitstring<KeyBitStringTraits>(address));
+		return NO_INDEX != n ? &m_values[m_nodes[n].m_value] : nullptr;
+	}
+
+	const value_t* value_exact(key_t const& key) const {
+		index_t const n = intern_exact_lookup(key_to_bs(key));
+		return NO_INDEX != n ? &m_values[m_nodes[n].m_value] : nullptr;
+	}
+
+	bool empty() const {
+		return m_values.empty();
+	}
+
+	size_t size() const {
+		return m_values.size();
+	}
+
+	// bytes allocated for the table itself (not counting memory owned by keys or values)
+	size_t memory_usage() const {
+		return sizeof(*this) + m_nodes.capacity() * sizeof(inner_node) + m_values.capacity() * sizeof(value_t);
+	}
+
+	// see radix_tree::generation()
+	uint64_t generation() const {
+		return m_generation.value();
+	}
+
+	const_iterator begin() const { return const_iterator(this, root(), root()); }
+	const_iterator end() const { return const_iterator(this, NO_INDEX, root()); }
+	const_iterator cbegin() const { return const_iterator(this, root(), root()); }
+	const_iterator cend() const { return const_iterator(this, NO_INDEX, root()); }
+
+	/** swap content of two trees */
+	friend void swap(frozen_radix_tree& a, frozen_radix_tree& b) {
+		using std::swap;
+		swap(a.m_nodes, b.m_nodes);
+		swap(a.m_values, b.m_values);
+		swap(a.m_generation, b.m_generation);
+	}
+};
+
+template<typename Key, typename Value, typename KeyBitStringTraits>
+constexpr typename frozen_radix_tree<Key, Value, KeyBitStringTraits>::index_t frozen_radix_tree<Key, Value, KeyBitStringTraits>::NO_INDEX;
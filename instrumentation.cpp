@@ -0,0 +1,83 @@
+#include "instrumentation.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace instrumentation {
+	namespace {
+		struct registry {
+			std::mutex m_mutex;
+			std::vector<detail::thread_counters*> m_threads;
+			// counters of threads which already exited
+			counters m_retired;
+		};
+
+		// never destroyed: threads might exit after static destruction started
+		registry& get_registry() {
+			static registry* const s_registry = new registry();
+			return *s_registry;
+		}
+
+		char const* const s_counter_names[COUNTER_COUNT] = {
+			"vector_lookups",
+			"vector_inserts",
+			"vector_erases",
+			"key_compares",
+			"ancestor_hops",
+			"insert_fixup_elements",
+			"erase_fixup_elements",
+			"radix_lookups",
+			"radix_inserts",
+			"radix_erases",
+			"radix_lookup_nodes",
+			"radix_insert_nodes",
+			"radix_merge_nodes",
+		};
+	}
+
+	char const* counter_name(counter c) {
+		return s_counter_names[static_cast<size_t>(c)];
+	}
+
+	counters aggregate() {
+		registry& r = get_registry();
+		std::lock_guard<std::mutex> lock(r.m_mutex);
+		counters result = r.m_retired;
+		for (auto const* t: r.m_threads) result += t->load();
+		return result;
+	}
+
+	void reset() {
+		registry& r = get_registry();
+		std::lock_guard<std::mutex> lock(r.m_mutex);
+		r.m_retired = counters{};
+		for (auto* t: r.m_threads) t->clear();
+	}
+
+	namespace detail {
+		thread_counters::thread_counters() {
+			for (auto& value: m_values) value.store(0, std::memory_order_relaxed);
+			registry& r = get_registry();
+			std::lock_guard<std::mutex> lock(r.m_mutex);
+			r.m_threads.push_back(this);
+		}
+
+		thread_counters::~thread_counters() {
+			registry& r = get_registry();
+			std::lock_guard<std::mutex> lock(r.m_mutex);
+			r.m_retired += load();
+			r.m_threads.erase(std::find(r.m_threads.begin(), r.m_threads.end(), this));
+		}
+
+		counters thread_counters::load() const {
+			counters result;
+			for (size_t i = 0; i < COUNTER_COUNT; ++i) result.values[i] = m_values[i].load(std::memory_order_relaxed);
+			return result;
+		}
+
+		void thread_counters::clear() {
+			for (auto& value: m_values) value.store(0, std::memory_order_relaxed);
+		}
+	}
+}
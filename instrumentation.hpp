@@ -0,0 +1,98 @@
+#pragma once
+
+#include <atomic>
+
+#include <stddef.h>
+#include <stdint.h>
+
+// optional hot path counters for the prefix tables.
+//
+// counting is only compiled in when PREFIX_TABLE_INSTRUMENTATION is defined (cmake option
+// PREFIX_TABLE_INSTRUMENTATION); otherwise PREFIX_TABLE_COUNT expands to nothing and
+// aggregate() always returns zeroes.
+// every thread counts into its own counters; aggregate() sums the counters of all threads
+// (including threads which already exited).
+namespace instrumentation {
+	enum class counter : size_t {
+		// prefix_vector
+		vector_lookups,         // lookups (find, find_exact, value, erase by key)
+		vector_inserts,         // single element inserts (including updates of existing keys)
+		vector_erases,
+		key_compares,           // compare_keys calls during binary searches
+		ancestor_hops,          // ancestor chain entries visited in find_ancestor_index and rebuild_ancestors
+		insert_fixup_elements,  // elements touched fixing ancestors after inserts
+		erase_fixup_elements,   // elements touched fixing ancestors after erases
+
+		// radix_tree
+		radix_lookups,          // lookups (find, find_exact, find_all, value, erase by key)
+		radix_inserts,
+		radix_erases,
+		radix_lookup_nodes,     // nodes visited during lookups
+		radix_insert_nodes,     // nodes visited during inserts
+		radix_merge_nodes,      // nodes visited merging up after erases
+
+		count_,
+	};
+
+	static constexpr size_t COUNTER_COUNT{static_cast<size_t>(counter::count_)};
+
+	char const* counter_name(counter c);
+
+	// plain snapshot of counter values
+	struct counters {
+		uint64_t values[COUNTER_COUNT]{};
+
+		uint64_t operator[](counter c) const { return values[static_cast<size_t>(c)]; }
+		uint64_t& operator[](counter c) { return values[static_cast<size_t>(c)]; }
+
+		counters& operator+=(counters const& other) {
+			for (size_t i = 0; i < COUNTER_COUNT; ++i) values[i] += other.values[i];
+			return *this;
+		}
+	};
+
+	// sum of the counters of all threads
+	counters aggregate();
+
+	// set counters of all threads to zero; counts of other threads running concurrently might
+	// get lost or survive the reset.
+	void reset();
+
+	namespace detail {
+		// counters of a single thread; registers itself for aggregate() and reset().
+		// only the owning thread modifies the values, so no atomic read-modify-write is needed.
+		class thread_counters {
+		private:
+			std::atomic<uint64_t> m_values[COUNTER_COUNT];
+
+		public:
+			thread_counters();
+			thread_counters(thread_counters const& other) = delete;
+			thread_counters& operator=(thread_counters const& other) = delete;
+			~thread_counters();
+
+			void add(counter c, uint64_t n) {
+				std::atomic<uint64_t>& value = m_values[static_cast<size_t>(c)];
+				value.store(value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+			}
+
+			counters load() const;
+			void clear();
+		};
+
+		inline thread_counters& local() {
+			static thread_local thread_counters t_counters;
+			return t_counters;
+		}
+	}
+
+	inline void add(counter c, uint64_t n = 1) {
+		detail::local().add(c, n);
+	}
+}
+
+#if defined(PREFIX_TABLE_INSTRUMENTATION)
+# define PREFIX_TABLE_COUNT(name, n) (::instrumentation::add(::instrumentation::counter::name, (n)))
+#else
+# define PREFIX_TABLE_COUNT(name, n) ((void) 0)
+#endif
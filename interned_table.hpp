@@ -0,0 +1,183 @@
+#pragma once
+
+#include "bitstring.hpp"
+#include "prefix_vector.hpp"
+#include "value_pool.hpp"
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+// table (any prefix_vector or radix_tree instantiation with `Id` values) storing small ids
+// into a value_pool instead of full values: entries with equal values share one copy in the
+// pool, and the keys and ids pack much denser in cache.
+//
+// lookups return pointers into the pool, which stay valid until the last entry with that
+// value is erased or reassigned. replace_value() changes a value for all entries using it
+// with a single write (the table itself, and with it the generation, doesn't change).
+template<
+	typename Key,
+	typename Value,
+	typename KeyBitStringTraits,
+	typename Id = uint16_t,
+	typename Table = prefix_vector<Key, Id, KeyBitStringTraits>,
+	typename Hash = std::hash<Value>>
+class interned_table {
+public:
+	typedef Key key_t;
+	typedef Value value_t;
+	typedef Id id_t;
+	typedef Table table_t;
+	typedef value_pool<Value, Id, Hash> pool_t;
+
+private:
+	table_t m_table;
+	pool_t m_pool;
+
+	value_t const* to_value(id_t const* id) const {
+		return id ? &m_pool[*id] : nullptr;
+	}
+
+	// reference counts after a batch insert into the table
+	void recount() {
+		std::vector<id_t> ids;
+		ids.reserve(m_table.size());
+		for (auto const& elem: m_table) ids.push_back(elem.value());
+		m_pool.recount(ids.begin(), ids.end());
+	}
+
+public:
+	interned_table() = default;
+
+	// the underlying table and pool (must not be modified directly)
+	table_t const& table() const {
+		return m_table;
+	}
+
+	pool_t const& pool() const {
+		return m_pool;
+	}
+
+	// value from entry with longest matching prefix of key or nullptr
+	value_t const* value(key_t const& key) const {
+		return to_value(m_table.value(key));
+	}
+
+	// same by address (see KeyBitStringTraits::address_to_bitstring in bitstring.hpp)
+	template<typename Address, typename = decltype(traits_address_to_bitstring<KeyBitStringTraits>(std::declval<Address const&>()))>
+	value_t const* value(Address const& address) const {
+		return to_value(m_table.value(address));
+	}
+
+	// value from entry with key equal to given key or nullptr
+	value_t const* value_exact(key_t const& key) const {
+		auto const it = m_table.find_exact(key);
+		return (it == m_table.end()) ? nullptr : &m_pool[it->value()];
+	}
+
+	// insert, but don't overwrite existing entry (returns false if key is already present)
+	bool insert(key_t const& key, value_t const& value) {
+		if (m_table.find_exact(key) != m_table.end()) return false;
+		id_t const id = m_pool.acquire(value);
+		try {
+			m_table.insert(key, id);
+		} catch (...) {
+			m_pool.release(id);
+			throw;
+		}
+		return true;
+	}
+
+	// insert, or assign if key is already present
+	void insert_or_assign(key_t const& key, value_t const& value) {
+		id_t const id = m_pool.acquire(value);
+		auto const it = m_table.find_exact(key);
+		bool const existed = (it != m_table.end());
+		id_t const old_id = existed ? it->value() : id_t{0};
+		try {
+			m_table.insert_or_assign(key, id);
+		} catch (...) {
+			m_pool.release(id);
+			throw;
+		}
+		if (existed) m_pool.release(old_id);
+	}
+
+	// insert all (key, value) pairs from the given range, but don't overwrite existing entries
+	template<typename InputIterator>
+	void insert(InputIterator first, InputIterator last) {
+		std::vector<std::pair<key_t, id_t>> entries;
+		for (; first != last; ++first) entries.emplace_back(first->first, m_pool.acquire(first->second));
+		try {
+			m_table.insert(entries.begin(), entries.end());
+		} catch (...) {
+			recount();
+			throw;
+		}
+		recount();
+	}
+
+	// insert, or assign if key is already present, all (key, value) pairs from the given range
+	template<typename InputIterator>
+	void insert_or_assign(InputIterator first, InputIterator last) {
+		std::vector<std::pair<key_t, id_t>> entries;
+		for (; first != last; ++first) entries.emplace_back(first->first, m_pool.acquire(first->second));
+		try {
+			m_table.insert_or_assign(entries.begin(), entries.end());
+		} catch (...) {
+			recount();
+			throw;
+		}
+		recount();
+	}
+
+	// erase element with given key. returns how many elements were deleted (0 or 1)
+	size_t erase(key_t const& key) {
+		auto const it = m_table.find_exact(key);
+		if (it == m_table.end()) return 0;
+		id_t const id = it->value();
+		m_table.erase(key);
+		m_pool.release(id);
+		return 1;
+	}
+
+	// replace old_value with new_value in all entries; fails (returns false) if old_value isn't
+	// used or new_value already is
+	bool replace_value(value_t const& old_value, value_t const& new_value) {
+		id_t id;
+		if (!m_pool.find(old_value, id)) return false;
+		return m_pool.replace(id, new_value);
+	}
+
+	// calls `f(key, value)` for all entries (in table order)
+	template<typename Function>
+	void for_each(Function&& f) const {
+		for (auto const& elem: m_table) f(elem.key(), m_pool[elem.value()]);
+	}
+
+	bool empty() const {
+		return m_table.empty();
+	}
+
+	size_t size() const {
+		return m_table.size();
+	}
+
+	// number of distinct values
+	size_t value_count() const {
+		return m_pool.size();
+	}
+
+	// bytes allocated for the table and the pool (not counting memory owned by keys or values)
+	size_t memory_usage() const {
+		return m_table.memory_usage() + m_pool.memory_usage();
+	}
+
+	// changes on every modification of the table (see table_generation)
+	uint64_t generation() const {
+		return m_table.generation();
+	}
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "ipv4_network.hpp"
+#include "ipv6_network.hpp"
+
+#include <string>
+
+#include <cassert>
+
+// either an ipv4_network or an ipv6_network
+class ip_network {
+private:
+	ipv4_network m_ipv4{};
+	ipv6_network m_ipv6{};
+	bool m_is_ipv6{false};
+
+public:
+	ip_network() = default;
+	/* implicit */ ip_network(ipv4_network network)
+	: m_ipv4(network) {
+	}
+	/* implicit */ ip_network(ipv6_network network)
+	: m_ipv6(network), m_is_ipv6(true) {
+	}
+
+	bool is_ipv4() const { return !m_is_ipv6; }
+	bool is_ipv6() const { return m_is_ipv6; }
+
+	ipv4_network const& ipv4() const {
+		assert(is_ipv4());
+		return m_ipv4;
+	}
+
+	ipv6_network const& ipv6() const {
+		assert(is_ipv6());
+		return m_ipv6;
+	}
+};
+
+inline std::string to_string(ip_network const& value) {
+	return value.is_ipv6() ? to_string(value.ipv6()) : to_string(value.ipv4());
+}
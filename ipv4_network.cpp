@@ -1,22 +1,94 @@
 #include "ipv4_network.hpp"
+#include "builtins.hpp"
 
-#include <sstream>
+#include <cstring>
+
+constexpr size_t ipv4_network::max_string_length;
+
+namespace {
+	// parse decimal number with at most `max_digits` digits and a value <= max_value
+	bool parse_decimal(char const*& pos, char const* end, unsigned int max_digits, uint32_t max_value, uint32_t& result) {
+		uint32_t value = 0;
+		unsigned int digits = 0;
+		for (; pos != end && digits < max_digits && *pos >= '0' && *pos <= '9'; ++pos, ++digits) {
+			value = 10*value + static_cast<uint32_t>(*pos - '0');
+		}
+		if (0 == digits || value > max_value) return false;
+		if (pos != end && *pos >= '0' && *pos <= '9') return false; // too many digits
+		result = value;
+		return true;
+	}
+
+	// value < 1000
+	char* format_decimal(char* out, uint32_t value) {
+		if (value >= 100) *out++ = static_cast<char>('0' + value / 100);
+		if (value >= 10) *out++ = static_cast<char>('0' + (value / 10) % 10);
+		*out++ = static_cast<char>('0' + value % 10);
+		return out;
+	}
+}
 
 std::string to_string(ipv4_network value)
 {
+	char buf[ipv4_network::max_string_length];
+	return std::string(buf, format_to(buf, value));
+}
+
+char* format_to(char* out, ipv4_network value) {
 	uint32_t native_address = value.native_address();
-	std::stringstream out;
-	out
-		<< (uint32_t{0xffu} & (native_address >> 24))
-		<< '.'
-		<< (uint32_t{0xffu} & (native_address >> 16))
-		<< '.'
-		<< (uint32_t{0xffu} & (native_address >> 8))
-		<< '.'
-		<< (uint32_t{0xffu} & native_address)
-		<< '/'
-		<< uint32_t{value.network()};
-	return out.str();
+	out = format_decimal(out, uint32_t{0xffu} & (native_address >> 24));
+	*out++ = '.';
+	out = format_decimal(out, uint32_t{0xffu} & (native_address >> 16));
+	*out++ = '.';
+	out = format_decimal(out, uint32_t{0xffu} & (native_address >> 8));
+	*out++ = '.';
+	out = format_decimal(out, uint32_t{0xffu} & native_address);
+	*out++ = '/';
+	return format_decimal(out, uint32_t{value.network()});
+}
+
+bool parse_ipv4_network(char const* str, size_t length, ipv4_network& result) {
+	char const* pos = str;
+	char const* const end = str + length;
+
+	uint32_t native_address = 0;
+	for (unsigned int i = 0; i < 4; ++i) {
+		if (0 != i) {
+			if (pos == end || '.' != *pos) return false;
+			++pos;
+		}
+		uint32_t octet;
+		if (!parse_decimal(pos, end, 3, 255, octet)) return false;
+		native_address = (native_address << 8) | octet;
+	}
+
+	uint32_t network = 32;
+	if (pos != end) {
+		if ('/' != *pos) return false;
+		++pos;
+		if (!parse_decimal(pos, end, 2, 32, network)) return false;
+		if (pos != end) return false;
+	}
+
+	result = ipv4_network(htonl(native_address), static_cast<unsigned char>(network));
+	return true;
+}
+
+char const* parse_ipv4_networks(char const* begin, char const* end, std::vector<ipv4_network>& result) {
+	while (begin != end) {
+		// memchr is vectorized in common C libraries
+		char const* eol = static_cast<char const*>(std::memchr(begin, '\n', static_cast<size_t>(end - begin)));
+		char const* const next = eol ? eol + 1 : end;
+		if (!eol) eol = end;
+		if (eol != begin && '\r' == eol[-1]) --eol;
+		if (eol != begin) {
+			ipv4_network network;
+			if (!parse_ipv4_network(begin, static_cast<size_t>(eol - begin), network)) return begin;
+			result.push_back(network);
+		}
+		begin = next;
+	}
+	return end;
 }
 
 bool operator==(ipv4_network_bitstring const& a, ipv4_network_bitstring const& b) {
@@ -57,16 +129,13 @@ bool is_tree_less(ipv4_network_bitstring const& a, ipv4_network_bitstring const&
 }
 
 bool is_prefix(ipv4_network_bitstring const& prefix, ipv4_network_bitstring const& str) {
-	return prefix == str.truncate(prefix.length());
+	if (prefix.value.network() > str.value.network()) return false;
+	return prefix.value.address() == (str.value.address() & ipv4_network::netmask(prefix.value.network()));
 }
 
-#if !defined(__has_builtin)
-# define __has_builtin(x) 0
-#endif
-
 ipv4_network_bitstring longest_common_prefix(ipv4_network_bitstring const& a, ipv4_network_bitstring const& b) {
 	uint32_t native_uncommon_bits = ntohl((a.value.address() ^ b.value.address()) | ipv4_network::hostmask(std::min(a.value.network(), b.value.network())));
-#if defined(__GNUC__) || (__has_builtin(__builtin_clz) && __has_builtin(__builtin_clzl))
+#if defined(__GNUC__) || (PREFIX_TABLE_HAS_BUILTIN(__builtin_clz) && PREFIX_TABLE_HAS_BUILTIN(__builtin_clzl))
 	size_t length;
 	if (sizeof(unsigned int) >= sizeof(uint32_t)) {
 		length = static_cast<size_t>(__builtin_clz(native_uncommon_bits)) - 8*(sizeof(unsigned int) - sizeof(uint32_t));
@@ -1,7 +1,9 @@
 #pragma once
 
 #include <algorithm>
+#include <functional>
 #include <string>
+#include <vector>
 
 #include <stddef.h>
 #include <stdint.h>
@@ -15,6 +17,9 @@ private:
 	unsigned char m_network{0};
 
 public:
+	// length of the longest text representation ("255.255.255.255/32")
+	static constexpr size_t max_string_length{18};
+
 	static uint32_t hostmask(unsigned char network) {
 		if (network >= 32) network = 32;
 		return htonl(static_cast<uint32_t>((uint64_t{1} << (32u - network)) - 1u));
@@ -36,8 +41,43 @@ public:
 	uint32_t native_address() const { return ntohl(m_address); }
 	unsigned char network() const { return m_network; }
 };
+
+inline bool operator==(ipv4_network a, ipv4_network b) {
+	return a.address() == b.address() && a.network() == b.network();
+}
+
+inline bool operator!=(ipv4_network a, ipv4_network b) {
+	return !(a == b);
+}
+
+namespace std {
+	template<>
+	struct hash<ipv4_network> {
+		size_t operator()(ipv4_network value) const {
+			// multiplicative hashing; fold the high half down so all bits are well mixed
+			uint64_t const h = ((uint64_t{value.address()} << 8) | value.network()) * UINT64_C(0x9e3779b97f4a7c15);
+			return static_cast<size_t>(h ^ (h >> 32));
+		}
+	};
+}
+
+// IPv4 address in host byte order, for lookups by address (a plain uint32_t is taken in network byte order)
+struct ipv4_host_address {
+	uint32_t value;
+};
+
 std::string to_string(ipv4_network value);
 
+// writes "a.b.c.d/n" to out (needs ipv4_network::max_string_length bytes, no terminating NUL); returns end of text
+char* format_to(char* out, ipv4_network value);
+
+// parses "a.b.c.d/n" or "a.b.c.d" (as /32); host bits are cleared. returns false on malformed input
+bool parse_ipv4_network(char const* str, size_t length, ipv4_network& result);
+
+// parses one network per line (empty lines are skipped) and appends them to result.
+// returns the start of the first malformed line, or `end` on success
+char const* parse_ipv4_networks(char const* begin, char const* end, std::vector<ipv4_network>& result);
+
 struct ipv4_network_bitstring {
 	ipv4_network value{};
 
@@ -80,4 +120,17 @@ struct ipv4_network_bitstring_traits {
 	value_type bitstring_to_value(bitstring bs) {
 		return bs.value;
 	}
+
+	// full length bitstrings for lookups by address
+	bitstring address_to_bitstring(uint32_t address) {
+		return bitstring(ipv4_network(address));
+	}
+
+	bitstring address_to_bitstring(in_addr address) {
+		return bitstring(ipv4_network(address.s_addr));
+	}
+
+	bitstring address_to_bitstring(ipv4_host_address address) {
+		return bitstring(ipv4_network(htonl(address.value)));
+	}
 };
@@ -0,0 +1,136 @@
+#include "ipv6_network.hpp"
+#include "builtins.hpp"
+
+#include <cstring>
+
+#include <arpa/inet.h>
+
+constexpr size_t ipv6_network::max_string_length;
+
+std::string to_string(ipv6_network value)
+{
+	char buf[ipv6_network::max_string_length];
+	return std::string(buf, format_to(buf, value));
+}
+
+char* format_to(char* out, ipv6_network value) {
+	in6_addr const address = value.address();
+	char buf[INET6_ADDRSTRLEN];
+	inet_ntop(AF_INET6, &address, buf, sizeof(buf));
+	size_t const address_length = std::strlen(buf);
+	std::memcpy(out, buf, address_length);
+	out += address_length;
+	*out++ = '/';
+	uint32_t const network = value.network();
+	if (network >= 100) *out++ = static_cast<char>('0' + network / 100);
+	if (network >= 10) *out++ = static_cast<char>('0' + (network / 10) % 10);
+	*out++ = static_cast<char>('0' + network % 10);
+	return out;
+}
+
+bool parse_ipv6_network(char const* str, size_t length, ipv6_network& result) {
+	char const* const end = str + length;
+	char const* slash = static_cast<char const*>(std::memchr(str, '/', length));
+	char const* const address_end = slash ? slash : end;
+
+	// inet_pton needs a NUL-terminated string
+	char buf[INET6_ADDRSTRLEN];
+	size_t const address_length = static_cast<size_t>(address_end - str);
+	if (address_length >= sizeof(buf)) return false;
+	std::memcpy(buf, str, address_length);
+	buf[address_length] = '\0';
+	in6_addr address;
+	if (1 != inet_pton(AF_INET6, buf, &address)) return false;
+
+	unsigned int network = 128;
+	if (slash) {
+		char const* pos = slash + 1;
+		if (pos == end || end - pos > 3) return false;
+		network = 0;
+		for (; pos != end; ++pos) {
+			if (*pos < '0' || *pos > '9') return false;
+			network = 10*network + static_cast<unsigned int>(*pos - '0');
+		}
+		if (network > 128) return false;
+	}
+
+	result = ipv6_network(address, static_cast<unsigned char>(network));
+	return true;
+}
+
+char const* parse_ipv6_networks(char const* begin, char const* end, std::vector<ipv6_network>& result) {
+	while (begin != end) {
+		// memchr is vectorized in common C libraries
+		char const* eol = static_cast<char const*>(std::memchr(begin, '\n', static_cast<size_t>(end - begin)));
+		char const* const next = eol ? eol + 1 : end;
+		if (!eol) eol = end;
+		if (eol != begin && '\r' == eol[-1]) --eol;
+		if (eol != begin) {
+			ipv6_network network;
+			if (!parse_ipv6_network(begin, static_cast<size_t>(eol - begin), network)) return begin;
+			result.push_back(network);
+		}
+		begin = next;
+	}
+	return end;
+}
+
+bool operator==(ipv6_network_bitstring const& a, ipv6_network_bitstring const& b) {
+	return a.value.network() == b.value.network() && a.value.high() == b.value.high() && a.value.low() == b.value.low();
+}
+
+bool operator!=(ipv6_network_bitstring const& a, ipv6_network_bitstring const& b) {
+	return !(a == b);
+}
+
+bool is_lexicographic_less(ipv6_network_bitstring const& a, ipv6_network_bitstring const& b) {
+	if (a.value.high() == b.value.high() && a.value.low() == b.value.low()) {
+		// one is prefix of the other; shorter comes first
+		return a.value.network() < b.value.network();
+	}
+	// only the smaller one can be a "real" prefix of the other
+	if (a.value.high() != b.value.high()) return a.value.high() < b.value.high();
+	return a.value.low() < b.value.low();
+}
+
+bool is_tree_less(ipv6_network_bitstring const& a, ipv6_network_bitstring const& b) {
+	unsigned char trunc_len = std::min(a.value.network(), b.value.network());
+	uint64_t const mask_high = ipv6_network::netmask_high(trunc_len);
+	uint64_t const mask_low = ipv6_network::netmask_low(trunc_len);
+	uint64_t const a_high_trunc = mask_high & a.value.high();
+	uint64_t const b_high_trunc = mask_high & b.value.high();
+	if (a_high_trunc != b_high_trunc) return a_high_trunc < b_high_trunc;
+	uint64_t const a_low_trunc = mask_low & a.value.low();
+	uint64_t const b_low_trunc = mask_low & b.value.low();
+	if (a_low_trunc != b_low_trunc) return a_low_trunc < b_low_trunc;
+	// one is prefix of the other
+	if (a.value.network() == b.value.network()) return false; // a == b
+	// 0 <= trunc_len < 128
+	if (a.value.network() < b.value.network()) { // a prefix of b: a is smaller if b continues with 1
+		return ipv6_network_bitstring(b.value)[trunc_len];
+	} else { // b prefix of a: a is smaller if it continues with 0
+		return !ipv6_network_bitstring(a.value)[trunc_len];
+	}
+}
+
+bool is_prefix(ipv6_network_bitstring const& prefix, ipv6_network_bitstring const& str) {
+	if (prefix.value.network() > str.value.network()) return false;
+	unsigned char const len = prefix.value.network();
+	return prefix.value.high() == (str.value.high() & ipv6_network::netmask_high(len))
+		&& prefix.value.low() == (str.value.low() & ipv6_network::netmask_low(len));
+}
+
+ipv6_network_bitstring longest_common_prefix(ipv6_network_bitstring const& a, ipv6_network_bitstring const& b) {
+	size_t const min_len = std::min(a.value.network(), b.value.network());
+	uint64_t const uncommon_high = a.value.high() ^ b.value.high();
+	uint64_t const uncommon_low = a.value.low() ^ b.value.low();
+	size_t length;
+	if (0 != uncommon_high) {
+		length = builtins_detail::count_leading_zeros(uncommon_high);
+	} else if (0 != uncommon_low) {
+		length = 64 + builtins_detail::count_leading_zeros(uncommon_low);
+	} else {
+		length = 128;
+	}
+	return a.truncate(std::min(length, min_len));
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+#include <netinet/in.h>
+
+class ipv6_network {
+private:
+	// native byte order, m_high holds the first 64 bits of the address.
+	// always clean, i.e. contains no bits outside the netmask.
+	uint64_t m_high{0};
+	uint64_t m_low{0};
+	// network length
+	unsigned char m_network{0};
+
+	static uint64_t load_word(unsigned char const* bytes) {
+		uint64_t result = 0;
+		for (size_t i = 0; i < 8; ++i) result = (result << 8) | bytes[i];
+		return result;
+	}
+
+	static void store_word(unsigned char* bytes, uint64_t word) {
+		for (size_t i = 8; i-- > 0; word >>= 8) bytes[i] = static_cast<unsigned char>(word);
+	}
+
+public:
+	// length of the longest text representation ("ffff:ffff:ffff:ffff:ffff:ffff:255.255.255.255/128")
+	static constexpr size_t max_string_length{49};
+
+	// native netmask for the high word
+	static uint64_t netmask_high(unsigned char network) {
+		if (network >= 64) return ~uint64_t{0};
+		return ~(~uint64_t{0} >> network);
+	}
+
+	// native netmask for the low word
+	static uint64_t netmask_low(unsigned char network) {
+		if (network <= 64) return 0;
+		if (network >= 128) return ~uint64_t{0};
+		return ~(~uint64_t{0} >> (network - 64u));
+	}
+
+	ipv6_network() = default;
+	explicit ipv6_network(uint64_t high, uint64_t low, unsigned char network)
+	: m_high(high & netmask_high(network)), m_low(low & netmask_low(network)), m_network(std::min<unsigned char>(network, 128u)) {
+	}
+	explicit ipv6_network(uint64_t high, uint64_t low)
+	: m_high(high), m_low(low), m_network(128) {
+	}
+	explicit ipv6_network(in6_addr const& address, unsigned char network)
+	: ipv6_network(load_word(address.s6_addr), load_word(address.s6_addr + 8), network) {
+	}
+	explicit ipv6_network(in6_addr const& address)
+	: ipv6_network(load_word(address.s6_addr), load_word(address.s6_addr + 8)) {
+	}
+
+	uint64_t high() const { return m_high; }
+	uint64_t low() const { return m_low; }
+	in6_addr address() const {
+		in6_addr result;
+		store_word(result.s6_addr, m_high);
+		store_word(result.s6_addr + 8, m_low);
+		return result;
+	}
+	unsigned char network() const { return m_network; }
+};
+
+inline bool operator==(ipv6_network const& a, ipv6_network const& b) {
+	return a.high() == b.high() && a.low() == b.low() && a.network() == b.network();
+}
+
+inline bool operator!=(ipv6_network const& a, ipv6_network const& b) {
+	return !(a == b);
+}
+
+namespace std {
+	template<>
+	struct hash<ipv6_network> {
+		size_t operator()(ipv6_network const& value) const {
+			uint64_t h = (value.high() ^ value.network()) * UINT64_C(0x9e3779b97f4a7c15);
+			h = (h ^ (h >> 32) ^ value.low()) * UINT64_C(0xc2b2ae3d27d4eb4f);
+			return static_cast<size_t>(h ^ (h >> 32));
+		}
+	};
+}
+
+std::string to_string(ipv6_network value);
+
+// writes "address/n" to out (needs ipv6_network::max_string_length bytes, no terminating NUL); returns end of text
+char* format_to(char* out, ipv6_network value);
+
+// parses "address/n" or "address" (as /128); host bits are cleared. returns false on malformed input
+bool parse_ipv6_network(char const* str, size_t length, ipv6_network& result);
+
+// parses one network per line (empty lines are skipped) and appends them to result.
+// returns the start of the first malformed line, or `end` on success
+char const* parse_ipv6_networks(char const* begin, char const* end, std::vector<ipv6_network>& result);
+
+struct ipv6_network_bitstring {
+	ipv6_network value{};
+
+	ipv6_network_bitstring() = default;
+	explicit ipv6_network_bitstring(ipv6_network val)
+	: value(val) {
+	}
+
+	size_t length() const { return value.network(); }
+
+	ipv6_network_bitstring truncate(size_t length) const {
+		unsigned char new_length = static_cast<unsigned char>(std::min<size_t>(length, value.network()));
+		return ipv6_network_bitstring(ipv6_network(value.high(), value.low(), new_length));
+	}
+
+	bool operator[](size_t ndx) const {
+		uint64_t const word = (ndx % 128u) < 64u ? value.high() : value.low();
+		uint64_t const native_mask = uint64_t{1} << (63u - (ndx % 64u));
+		return 0 != (word & native_mask);
+	}
+};
+bool operator==(ipv6_network_bitstring const& a, ipv6_network_bitstring const& b);
+bool operator!=(ipv6_network_bitstring const& a, ipv6_network_bitstring const& b);
+
+bool is_lexicographic_less(ipv6_network_bitstring const& a, ipv6_network_bitstring const& b);
+
+bool is_tree_less(ipv6_network_bitstring const& a, ipv6_network_bitstring const& b);
+
+bool is_prefix(ipv6_network_bitstring const& prefix, ipv6_network_bitstring const& str);
+
+ipv6_network_bitstring longest_common_prefix(ipv6_network_bitstring const& a, ipv6_network_bitstring const& b);
+
+struct ipv6_network_bitstring_traits {
+	typedef ipv6_network_bitstring bitstring;
+	typedef ipv6_network value_type;
+
+	bitstring value_to_bitstring(value_type val) {
+		return bitstring(val);
+	}
+
+	value_type bitstring_to_value(bitstring bs) {
+		return bs.value;
+	}
+
+	// full length bitstring for lookups by address
+	bitstring address_to_bitstring(in6_addr const& address) {
+		return bitstring(ipv6_network(address));
+	}
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "builtins.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include <cassert>
+
+#include <stddef.h>
+#include <stdint.h>
+
+// histogram of 64-bit values (e.g. latencies in timer ticks) with log-linear buckets
+// (like HdrHistogram): values below 2^SUB_BUCKET_BITS are counted exactly, larger values
+// with a relative error below 2^-(SUB_BUCKET_BITS - 1) (~1.6%).
+// recording is a few instructions and never allocates.
+class latency_histogram {
+public:
+	static constexpr unsigned int SUB_BUCKET_BITS{7};
+
+private:
+	static constexpr uint64_t HALF_BUCKET{uint64_t{1} << (SUB_BUCKET_BITS - 1)};
+	static constexpr size_t BUCKET_COUNT{(64 - SUB_BUCKET_BITS + 2) * HALF_BUCKET};
+
+	std::vector<uint64_t> m_counts;
+	uint64_t m_total{0};
+	uint64_t m_min{std::numeric_limits<uint64_t>::max()};
+	uint64_t m_max{0};
+	// sum of all values; might overflow for huge sample counts, only used for mean()
+	uint64_t m_sum{0};
+
+	static size_t bucket_index(uint64_t value) {
+		if (value < 2 * HALF_BUCKET) return static_cast<size_t>(value);
+		// value has more than SUB_BUCKET_BITS significant bits; keep the top SUB_BUCKET_BITS
+		unsigned int const shift = static_cast<unsigned int>(64 - builtins_detail::count_leading_zeros(value) - SUB_BUCKET_BITS);
+		return static_cast<size_t>(shift * HALF_BUCKET + (value >> shift));
+	}
+
+	// highest value counted in the bucket
+	static uint64_t bucket_upper_bound(size_t index) {
+		if (index < 2 * HALF_BUCKET) return index;
+		unsigned int const shift = static_cast<unsigned int>(index / HALF_BUCKET - 1);
+		uint64_t const mantissa = index - shift * HALF_BUCKET;
+		return ((mantissa + 1) << shift) - 1;
+	}
+
+public:
+	latency_histogram()
+	: m_counts(BUCKET_COUNT, 0) {
+	}
+
+	void record(uint64_t value) {
+		++m_counts[bucket_index(value)];
+		++m_total;
+		m_sum += value;
+		m_min = std::min(m_min, value);
+		m_max = std::max(m_max, value);
+	}
+
+	uint64_t count() const { return m_total; }
+	uint64_t min() const { return m_total ? m_min : 0; }
+	uint64_t max() const { return m_max; }
+
+	double mean() const {
+		return m_total ? static_cast<double>(m_sum) / static_cast<double>(m_total) : 0.0;
+	}
+
+	// smallest recorded value (rounded up to its bucket) so that at least `percentile` percent
+	// of all values are less than or equal to it
+	uint64_t value_at_percentile(double percentile) const {
+		if (0 == m_total) return 0;
+		double const wanted = std::min(100.0, std::max(0.0, percentile)) * static_cast<double>(m_total) / 100.0;
+		uint64_t const rank = std::max<uint64_t>(1, static_cast<uint64_t>(wanted + 0.5));
+		uint64_t seen = 0;
+		for (size_t i = 0; i < m_counts.size(); ++i) {
+			seen += m_counts[i];
+			if (seen >= rank) return std::min(bucket_upper_bound(i), m_max);
+		}
+		assert(false);
+		return m_max;
+	}
+
+	void merge(latency_histogram const& other) {
+		for (size_t i = 0; i < m_counts.size(); ++i) m_counts[i] += other.m_counts[i];
+		m_total += other.m_total;
+		m_sum += other.m_sum;
+		m_min = std::min(m_min, other.m_min);
+		m_max = std::max(m_max, other.m_max);
+	}
+
+	void clear() {
+		std::fill(m_counts.begin(), m_counts.end(), 0);
+		m_total = 0;
+		m_sum = 0;
+		m_min = std::numeric_limits<uint64_t>::max();
+		m_max = 0;
+	}
+};
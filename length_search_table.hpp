@@ -0,0 +1,628 @@
+#pragma once
+
+#include "bitstring.hpp"
+#include "table_generation.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <cassert>
+
+#include <stddef.h>
+#include <stdint.h>
+
+// longest prefix match by binary search on prefix lengths (Waldvogel et al., "Scalable High
+// Speed IP Routing Lookups"): one open addressing hash table per distinct prefix length.
+//
+// a lookup probes the table in the middle of the (sorted) lengths; on a hit it continues with
+// the longer lengths, otherwise with the shorter ones. to find longer prefixes through a hit,
+// every prefix leaves "markers" (its truncations) at all shorter lengths where the search
+// continues with the longer half on the way to its own length; every entry (marker or real
+// prefix) stores its best matching prefix (the longest real prefix of its key), so a lookup
+// never has to backtrack. lookups need O(log W) probes for keys of width W (at most 8 for
+// IPv6), find_exact() needs a single probe.
+//
+// single inserts and erases are incremental: they add or remove the markers on the search
+// path of the key (markers are reference counted), and update the best matching prefix of
+// the markers left by longer keys below it (found through an ordered index of all keys, so
+// updating a short prefix covering many keys is linear in their number). only inserting a
+// key with a new prefix length rebuilds all hash tables, as it changes the search paths of
+// all lengths; lengths which lose their last key stay until the next rebuild (range insert
+// or clear()).
+//
+// entries are kept in a vector in no particular order (erase moves the last entry into the
+// gap); the hash tables store indices into it.
+template<typename Key, typename Value, typename KeyBitStringTraits, typename Hash = std::hash<Key>>
+class length_search_table {
+public:
+	typedef Key key_t;
+	typedef Value value_t;
+	typedef uint32_t index_t;
+
+	static constexpr index_t NO_INDEX{~index_t{0}};
+
+	class element_type {
+	private:
+		friend class length_search_table;
+
+		key_t m_key{};
+		value_t m_value{};
+
+	public:
+		element_type() = default;
+		template<typename ArgKey, typename ArgValue>
+		explicit element_type(ArgKey&& key, ArgValue&& value)
+		: m_key(std::forward<ArgKey>(key)), m_value(std::forward<ArgValue>(value)) {
+		}
+
+		key_t const& key() const { return m_key; }
+		value_t const& value() const { return m_value; }
+		value_t& value() { return m_value; }
+	};
+
+private:
+	typedef std::vector<element_type> container_t;
+	typedef typename KeyBitStringTraits::bitstring bitstring;
+
+public:
+	typedef typename container_t::iterator iterator;
+	typedef typename container_t::const_iterator const_iterator;
+
+private:
+	struct slot {
+		key_t m_key{};
+		// best matching prefix: index of the longest entry which is a prefix of m_key
+		index_t m_bmp{NO_INDEX};
+		// number of entries which need m_key as marker on their search path
+		index_t m_markers{0};
+		bool m_used{false};
+		// m_key is an entry (m_bmp is its index), not only a marker
+		bool m_real{false};
+	};
+
+	struct level {
+		size_t m_length{0};
+		size_t m_used{0};
+		// power of two, at most 50% load
+		std::vector<slot> m_slots;
+	};
+
+	struct key_less {
+		bool operator()(key_t const& a, key_t const& b) const {
+			return is_lexicographic_less(key_to_bs(a), key_to_bs(b));
+		}
+	};
+
+	container_t m_entries;
+	// all keys in lexicographic order (the keys prefixed by a key follow it directly)
+	std::map<key_t, index_t, key_less> m_order;
+	// sorted by length
+	std::vector<level> m_levels;
+	size_t m_marker_count{0};
+	table_generation m_generation;
+
+	static bitstring key_to_bs(key_t const& key) {
+		KeyBitStringTraits keyBitStringTraits{};
+		return keyBitStringTraits.value_to_bitstring(key);
+	}
+
+	static key_t bs_to_key(bitstring const& bs) {
+		KeyBitStringTraits keyBitStringTraits{};
+		return keyBitStringTraits.bitstring_to_value(bs);
+	}
+
+	static size_t round_up_power_of_two(size_t n) {
+		size_t result = 1;
+		while (result < n) result <<= 1;
+		return result;
+	}
+
+	// slot with key equal to bs (bs must have the length of the level), or nullptr.
+	// constructs a key from bs to hash it (Hash is over key_t, bitstrings have no hash)
+	template<typename Level>
+	static auto probe(Level& l, bitstring const& bs) -> decltype(&l.m_slots[0]) {
+		size_t const mask = l.m_slots.size() - 1;
+		for (size_t i = Hash{}(bs_to_key(bs)) & mask; ; i = (i + 1) & mask) {
+			auto* const s = &l.m_slots[i];
+			if (!s->m_used) return nullptr;
+			if (key_to_bs(s->m_key) == bs) return s;
+		}
+	}
+
+	// double the slots of a level
+	static void grow(level& l) {
+		std::vector<slot> slots(std::max<size_t>(2, 2 * l.m_slots.size()));
+		slots.swap(l.m_slots);
+		size_t const mask = l.m_slots.size() - 1;
+		for (auto& s: slots) {
+			if (!s.m_used) continue;
+			size_t i = Hash{}(s.m_key) & mask;
+			while (l.m_slots[i].m_used) i = (i + 1) & mask;
+			l.m_slots[i] = std::move(s);
+		}
+	}
+
+	// slot for key (either the existing one or a new one); may grow the level, which moves
+	// all its slots
+	static slot& probe_insert(level& l, key_t const& key) {
+		if (2 * (l.m_used + 1) > l.m_slots.size()) grow(l);
+		bitstring const bs = key_to_bs(key);
+		size_t const mask = l.m_slots.size() - 1;
+		for (size_t i = Hash{}(key) & mask; ; i = (i + 1) & mask) {
+			slot& s = l.m_slots[i];
+			if (!s.m_used) {
+				s.m_used = true;
+				s.m_key = key;
+				++l.m_used;
+				return s;
+			}
+			if (key_to_bs(s.m_key) == bs) return s;
+		}
+	}
+
+	// free a used slot; moves following slots of the probe sequence into the gap unless
+	// their home slot is after the gap (cyclically)
+	static void remove_slot(level& l, slot& s) {
+		size_t const mask = l.m_slots.size() - 1;
+		size_t gap = static_cast<size_t>(&s - l.m_slots.data());
+		for (size_t i = (gap + 1) & mask; l.m_slots[i].m_used; i = (i + 1) & mask) {
+			size_t const home = Hash{}(l.m_slots[i].m_key) & mask;
+			bool const stays = (gap < i) ? (gap < home && home <= i) : (gap < home || home <= i);
+			if (!stays) {
+				l.m_slots[gap] = std::move(l.m_slots[i]);
+				gap = i;
+			}
+		}
+		l.m_slots[gap] = slot{};
+		--l.m_used;
+	}
+
+	// index of the level for length, or m_levels.size() if there is none
+	size_t find_level(size_t length) const {
+		auto const it = std::lower_bound(m_levels.begin(), m_levels.end(), length, [](level const& l, size_t len) { return l.m_length < len; });
+		if (it == m_levels.end() || it->m_length != length) return m_levels.size();
+		return static_cast<size_t>(it - m_levels.begin());
+	}
+
+	size_t level_index(size_t length) const {
+		size_t const result = find_level(length);
+		assert(result < m_levels.size());
+		return result;
+	}
+
+	size_t entry_length(index_t ndx) const {
+		return key_to_bs(m_entries[ndx].m_key).length();
+	}
+
+	// calls f(level index) for all levels where a lookup for a key of the level with index
+	// `target` continues with the longer lengths (the levels which need a marker)
+	template<typename Function>
+	void for_each_marker_level(size_t target, Function&& f) const {
+		size_t lo = 0;
+		size_t hi = m_levels.size();
+		while (lo < hi) {
+			size_t const mid = lo + (hi - lo) / 2;
+			if (mid == target) return;
+			if (mid < target) {
+				f(mid);
+				lo = mid + 1;
+			} else {
+				hi = mid;
+			}
+		}
+		assert(false);
+	}
+
+	// entry with the longest key which is a prefix of bs, only looking at the levels below
+	// `end_level` (or NO_INDEX)
+	index_t best_prefix(bitstring const& bs, size_t end_level) const {
+		for (size_t i = end_level; i-- > 0; ) {
+			slot const* const s = probe(m_levels[i], bs.truncate(m_levels[i].m_length));
+			if (s && s->m_real) return s->m_bmp;
+		}
+		return NO_INDEX;
+	}
+
+	// calls f(slot&) for all marker slots (not real entries) left by the keys which are
+	// prefixed by key (excluding key itself) at levels above key_level; the only markers
+	// whose best matching prefix can be key. may visit a slot more than once
+	template<typename Function>
+	void for_each_marker_below(key_t const& key, size_t key_level, Function&& f) {
+		bitstring const key_bs = key_to_bs(key);
+		for (auto it = m_order.lower_bound(key); it != m_order.end(); ++it) {
+			bitstring const bs = key_to_bs(it->first);
+			if (!is_prefix(key_bs, bs)) break;
+			if (bs.length() == key_bs.length()) continue;
+			for_each_marker_level(level_index(bs.length()), [&](size_t marker_level) {
+				if (marker_level <= key_level) return;
+				slot* const s = probe(m_levels[marker_level], bs.truncate(m_levels[marker_level].m_length));
+				assert(s);
+				if (!s->m_real) f(*s);
+			});
+		}
+	}
+
+	// add the hash table entries for m_entries[ndx] (whose length has a level)
+	void add_entry(index_t ndx, size_t key_level) {
+		key_t const& key = m_entries[ndx].m_key;
+		bitstring const bs = key_to_bs(key);
+		{
+			slot& s = probe_insert(m_levels[key_level], key);
+			// a marker so far
+			if (s.m_markers) --m_marker_count;
+			s.m_real = true;
+			s.m_bmp = ndx;
+		}
+		for_each_marker_level(key_level, [&](size_t marker_level) {
+			level& l = m_levels[marker_level];
+			bitstring const marker_bs = bs.truncate(l.m_length);
+			slot& s = probe_insert(l, bs_to_key(marker_bs));
+			if (!s.m_real && 0 == s.m_markers) {
+				s.m_bmp = best_prefix(marker_bs, marker_level);
+				++m_marker_count;
+			}
+			++s.m_markers;
+		});
+		size_t const length = bs.length();
+		for_each_marker_below(key, key_level, [&](slot& s) {
+			if (NO_INDEX == s.m_bmp || entry_length(s.m_bmp) < length) s.m_bmp = ndx;
+		});
+	}
+
+	// remove the hash table entries for m_entries[ndx]
+	void remove_entry(index_t ndx) {
+		key_t const& key = m_entries[ndx].m_key;
+		bitstring const bs = key_to_bs(key);
+		size_t const key_level = level_index(bs.length());
+		index_t const parent = best_prefix(bs, key_level);
+		for_each_marker_below(key, key_level, [&](slot& s) {
+			if (ndx == s.m_bmp) s.m_bmp = parent;
+		});
+		{
+			level& l = m_levels[key_level];
+			slot* const s = probe(l, bs);
+			assert(s && s->m_real);
+			s->m_real = false;
+			if (s->m_markers) {
+				// still needed as marker
+				s->m_bmp = parent;
+				++m_marker_count;
+			} else {
+				remove_slot(l, *s);
+			}
+		}
+		for_each_marker_level(key_level, [&](size_t marker_level) {
+			level& l = m_levels[marker_level];
+			slot* const s = probe(l, bs.truncate(l.m_length));
+			assert(s && s->m_markers);
+			if (0 == --s->m_markers && !s->m_real) {
+				remove_slot(l, *s);
+				--m_marker_count;
+			}
+		});
+	}
+
+	// move the last entry to index ndx (which must be unused)
+	void move_last_entry(index_t ndx) {
+		index_t const last = static_cast<index_t>(m_entries.size() - 1);
+		m_entries[ndx] = std::move(m_entries[last]);
+		key_t const& key = m_entries[ndx].m_key;
+		bitstring const bs = key_to_bs(key);
+		size_t const key_level = level_index(bs.length());
+		m_order.find(key)->second = ndx;
+		probe(m_levels[key_level], bs)->m_bmp = ndx;
+		for_each_marker_below(key, key_level, [&](slot& s) {
+			if (last == s.m_bmp) s.m_bmp = ndx;
+		});
+	}
+
+	void rebuild() {
+		m_generation.bump();
+		m_levels.clear();
+		m_marker_count = 0;
+		if (m_entries.empty()) return;
+		if (m_entries.size() >= NO_INDEX) throw std::length_error("length_search_table: too many entries");
+
+		std::vector<size_t> lengths;
+		for (auto const& elem: m_entries) lengths.push_back(key_to_bs(elem.m_key).length());
+		std::vector<size_t> distinct_lengths(lengths);
+		std::sort(distinct_lengths.begin(), distinct_lengths.end());
+		distinct_lengths.erase(std::unique(distinct_lengths.begin(), distinct_lengths.end()), distinct_lengths.end());
+		m_levels.resize(distinct_lengths.size());
+		for (size_t i = 0; i < distinct_lengths.size(); ++i) m_levels[i].m_length = distinct_lengths[i];
+
+		// size the hash tables for at most 50% load (counting markers before deduplication)
+		std::vector<size_t> level_of(m_entries.size());
+		std::vector<size_t> counts(m_levels.size(), 0);
+		for (size_t i = 0; i < m_entries.size(); ++i) {
+			level_of[i] = level_index(lengths[i]);
+			++counts[level_of[i]];
+			for_each_marker_level(level_of[i], [&counts](size_t marker_level) { ++counts[marker_level]; });
+		}
+		for (size_t i = 0; i < m_levels.size(); ++i) m_levels[i].m_slots.resize(round_up_power_of_two(2 * counts[i] + 2));
+
+		// ancestors (longest "real" prefix) of all entries; in lexicographic order all
+		// ancestors of an entry are on the stack
+		std::vector<index_t> ancestors(m_entries.size(), NO_INDEX);
+		{
+			std::vector<index_t> stack;
+			for (auto const& ordered: m_order) {
+				bitstring const bs = key_to_bs(ordered.first);
+				while (!stack.empty() && !is_prefix(key_to_bs(m_entries[stack.back()].m_key), bs)) stack.pop_back();
+				if (!stack.empty()) ancestors[ordered.second] = stack.back();
+				stack.push_back(ordered.second);
+			}
+		}
+
+		for (size_t i = 0; i < m_entries.size(); ++i) {
+			slot& s = probe_insert(m_levels[level_of[i]], m_entries[i].m_key);
+			s.m_bmp = static_cast<index_t>(i);
+			s.m_real = true;
+		}
+
+		for (size_t i = 0; i < m_entries.size(); ++i) {
+			bitstring const bs = key_to_bs(m_entries[i].m_key);
+			for_each_marker_level(level_of[i], [&](size_t marker_level) {
+				size_t const length = m_levels[marker_level].m_length;
+				slot& s = probe_insert(m_levels[marker_level], bs_to_key(bs.truncate(length)));
+				++s.m_markers;
+				if (s.m_real) return;
+				// all entries which are a prefix of the marker are ancestors of entry i
+				index_t bmp = ancestors[i];
+				while (NO_INDEX != bmp && lengths[bmp] > length) bmp = ancestors[bmp];
+				s.m_bmp = bmp;
+			});
+		}
+
+		for (auto const& l: m_levels) {
+			for (auto const& s: l.m_slots) {
+				if (s.m_used && !s.m_real) ++m_marker_count;
+			}
+		}
+	}
+
+	// index of entry with longest matching prefix of key_bs (or NO_INDEX)
+	index_t intern_lookup(bitstring const& key_bs) const {
+		index_t best = NO_INDEX;
+		size_t lo = 0;
+		size_t hi = m_levels.size();
+		while (lo < hi) {
+			size_t const mid = lo + (hi - lo) / 2;
+			level const& l = m_levels[mid];
+			slot const* const s = (l.m_length <= key_bs.length()) ? probe(l, key_bs.truncate(l.m_length)) : nullptr;
+			if (s) {
+				// a marker's best matching prefix is at least as long as any previous match
+				best = s->m_bmp;
+				lo = mid + 1;
+			} else {
+				hi = mid;
+			}
+		}
+		return best;
+	}
+
+	index_t intern_lookup_exact(bitstring const& key_bs) const {
+		size_t const key_level = find_level(key_bs.length());
+		if (key_level == m_levels.size()) return NO_INDEX;
+		slot const* const s = probe(m_levels[key_level], key_bs);
+		return (s && s->m_real) ? s->m_bmp : NO_INDEX;
+	}
+
+	const_iterator to_iterator(index_t ndx) const {
+		return (NO_INDEX == ndx) ? m_entries.end() : m_entries.begin() + static_cast<std::ptrdiff_t>(ndx);
+	}
+
+	iterator to_iterator(index_t ndx) {
+		return (NO_INDEX == ndx) ? m_entries.end() : m_entries.begin() + static_cast<std::ptrdiff_t>(ndx);
+	}
+
+	// append a new entry to m_entries and m_order (not to the hash tables)
+	template<typename ValueArg>
+	index_t append(key_t const& key, ValueArg&& value) {
+		if (m_entries.size() >= NO_INDEX - 1) throw std::length_error("length_search_table: too many entries");
+		index_t const ndx = static_cast<index_t>(m_entries.size());
+		m_entries.emplace_back(key, std::forward<ValueArg>(value));
+		try {
+			m_order.emplace(key, ndx);
+		} catch (...) {
+			m_entries.pop_back();
+			throw;
+		}
+		return ndx;
+	}
+
+	template<typename ValueArg>
+	std::pair<iterator, bool> intern_insert(key_t const& key, ValueArg&& value, bool overwrite) {
+		auto const found = m_order.find(key);
+		if (found != m_order.end()) {
+			iterator const pos = to_iterator(found->second);
+			if (!overwrite) return std::make_pair(pos, false);
+			pos->m_value = std::forward<ValueArg>(value);
+			m_generation.bump();
+			return std::make_pair(pos, true);
+		}
+		index_t const ndx = append(key, std::forward<ValueArg>(value));
+		size_t const key_level = find_level(key_to_bs(key).length());
+		if (key_level == m_levels.size()) {
+			// new length: the search paths of all lengths change
+			rebuild();
+		} else {
+			m_generation.bump();
+			try {
+				add_entry(ndx, key_level);
+			} catch (...) {
+				m_order.erase(key);
+				m_entries.pop_back();
+				rebuild();
+				throw;
+			}
+		}
+		return std::make_pair(to_iterator(ndx), true);
+	}
+
+	// insert all pairs, then rebuild once
+	template<typename InputIterator>
+	void intern_insert_range(InputIterator first, InputIterator last, bool overwrite) {
+		try {
+			for (; first != last; ++first) {
+				auto const found = m_order.find(first->first);
+				if (found == m_order.end()) {
+					append(first->first, first->second);
+				} else if (overwrite) {
+					m_entries[found->second].m_value = first->second;
+				}
+			}
+		} catch (...) {
+			rebuild();
+			throw;
+		}
+		rebuild();
+	}
+
+public:
+	length_search_table() = default;
+
+	// find entry with longest matching prefix of key (or end())
+	const_iterator find(key_t const& key) const {
+		return to_iterator(intern_lookup(key_to_bs(key)));
+	}
+
+	iterator find(key_t const& key) {
+		return to_iterator(intern_lookup(key_to_bs(key)));
+	}
+
+	// find entry with key equal to given key (a single hash probe)
+	const_iterator find_exact(key_t const& key) const {
+		return to_iterator(intern_lookup_exact(key_to_bs(key)));
+	}
+
+	iterator find_exact(key_t const& key) {
+		return to_iterator(intern_lookup_exact(key_to_bs(key)));
+	}
+
+	// value from entry found with find() or nullptr
+	value_t const* value(key_t const& key) const {
+		index_t const ndx = intern_lookup(key_to_bs(key));
+		return (NO_INDEX == ndx) ? nullptr : &m_entries[ndx].m_value;
+	}
+
+	value_t* value(key_t const& key) {
+		index_t const ndx = intern_lookup(key_to_bs(key));
+		return (NO_INDEX == ndx) ? nullptr : &m_entries[ndx].m_value;
+	}
+
+	// find() and value() by address (see KeyBitStringTraits::address_to_bitstring in
+	// bitstring.hpp) or by bitstring. Hash works on keys, so every probe still constructs a
+	// key from the truncated bitstring (up to log2(W) per lookup)
+	template<typename Address, typename = decltype(traits_address_to_bitstring<KeyBitStringTraits>(std::declval<Address const&>()))>
+	const_iterator find(Address const& address) const {
+		return to_iterator(intern_lookup(traits_address_to_bitstring<KeyBitStringTraits>(address)));
+	}
+
+	template<typename Address, typename = decltype(traits_address_to_bitstring<KeyBitStringTraits>(std::declval<Address const&>()))>
+	value_t const* value(Address const& address) const {
+		index_t const ndx = intern_lookup(traits_address_to_bitstring<KeyBitStringTraits>(address));
+		return (NO_INDEX == ndx) ? nullptr : &m_entries[ndx].m_value;
+	}
+
+	// insert, but don't overwrite existing entry (returns false if key is already present)
+	template<typename ValueArg>
+	std::pair<iterator, bool> insert(key_t const& key, ValueArg&& value) {
+		return intern_insert(key, std::forward<ValueArg>(value), false);
+	}
+
+	// insert, or assign if key is already present
+	template<typename ValueArg>
+	std::pair<iterator, bool> insert_or_assign(key_t const& key, ValueArg&& value) {
+		return intern_insert(key, std::forward<ValueArg>(value), true);
+	}
+
+	// insert all (key, value) pairs from the given range, but don't overwrite existing entries
+	// (the first pair wins for duplicate keys in the range); rebuilds the hash tables only once.
+	template<typename InputIterator>
+	void insert(InputIterator first, InputIterator last) {
+		intern_insert_range(first, last, false);
+	}
+
+	// insert, or assign if key is already present, all (key, value) pairs from the given range
+	// (the last pair wins for duplicate keys in the range)
+	template<typename InputIterator>
+	void insert_or_assign(InputIterator first, InputIterator last) {
+		intern_insert_range(first, last, true);
+	}
+
+	// erase element with given key. returns how many elements were deleted (0 or 1)
+	size_t erase(key_t const& key) {
+		auto const found = m_order.find(key);
+		if (found == m_order.end()) return 0;
+		index_t const ndx = found->second;
+		m_generation.bump();
+		remove_entry(ndx);
+		m_order.erase(found);
+		if (ndx != m_entries.size() - 1) move_last_entry(ndx);
+		m_entries.pop_back();
+		return 1;
+	}
+
+	void clear() {
+		m_entries.clear();
+		m_order.clear();
+		rebuild();
+	}
+
+	bool empty() const {
+		return m_entries.empty();
+	}
+
+	size_t size() const {
+		return m_entries.size();
+	}
+
+	// number of distinct prefix lengths (hash tables)
+	size_t length_count() const {
+		return m_levels.size();
+	}
+
+	// number of hash table entries which are only markers
+	size_t marker_count() const {
+		return m_marker_count;
+	}
+
+	// bytes allocated for the table itself (not counting memory owned by keys or values); the
+	// nodes of the ordered key index are estimated (value plus three pointers and a color)
+	size_t memory_usage() const {
+		size_t result = sizeof(*this) + m_entries.capacity() * sizeof(element_type) + m_levels.capacity() * sizeof(level);
+		for (auto const& l: m_levels) result += l.m_slots.capacity() * sizeof(slot);
+		result += m_order.size() * (sizeof(typename std::map<key_t, index_t, key_less>::value_type) + 4 * sizeof(void*));
+		return result;
+	}
+
+	// changes on every modification of the table (see table_generation)
+	uint64_t generation() const {
+		return m_generation.value();
+	}
+
+	friend void swap(length_search_table& a, length_search_table& b) {
+		using std::swap;
+		swap(a.m_entries, b.m_entries);
+		swap(a.m_order, b.m_order);
+		swap(a.m_levels, b.m_levels);
+		swap(a.m_marker_count, b.m_marker_count);
+		swap(a.m_generation, b.m_generation);
+	}
+
+	// entries in no particular order
+	iterator begin() { return m_entries.begin(); }
+	iterator end() { return m_entries.end(); }
+	const_iterator begin() const { return m_entries.begin(); }
+	const_iterator end() const { return m_entries.end(); }
+	const_iterator cbegin() const { return m_entries.begin(); }
+	const_iterator cend() const { return m_entries.end(); }
+};
+
+template<typename Key, typename Value, typename KeyBitStringTraits, typename Hash>
+constexpr typename length_search_table<Key, Value, KeyBitStringTraits, Hash>::index_t length_search_table<Key, Value, KeyBitStringTraits, Hash>::NO_INDEX;
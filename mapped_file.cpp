@@ -0,0 +1,61 @@
+#include "mapped_file.hpp"
+
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+mapped_file::mapped_file(mapped_file&& other) noexcept
+: m_data(other.m_data), m_size(other.m_size) {
+	other.m_data = nullptr;
+	other.m_size = 0;
+}
+
+mapped_file& mapped_file::operator=(mapped_file&& other) noexcept {
+	if (this != &other) {
+		close();
+		std::swap(m_data, other.m_data);
+		std::swap(m_size, other.m_size);
+	}
+	return *this;
+}
+
+mapped_file::~mapped_file() {
+	close();
+}
+
+bool mapped_file::open(char const* path) {
+	close();
+
+	int const fd = ::open(path, O_RDONLY | O_CLOEXEC);
+	if (-1 == fd) return false;
+
+	struct stat st;
+	if (-1 == fstat(fd, &st)) {
+		::close(fd);
+		return false;
+	}
+
+	// mmap fails for empty files; an empty mapping is fine though
+	if (st.st_size > 0) {
+		void* const data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		if (MAP_FAILED == data) {
+			::close(fd);
+			return false;
+		}
+		madvise(data, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+		m_data = data;
+		m_size = static_cast<size_t>(st.st_size);
+	}
+
+	::close(fd);
+	return true;
+}
+
+void mapped_file::close() {
+	if (m_data) munmap(m_data, m_size);
+	m_data = nullptr;
+	m_size = 0;
+}
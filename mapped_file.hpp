@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stddef.h>
+
+// read-only memory mapping of a complete file
+class mapped_file {
+private:
+	void* m_data{nullptr};
+	size_t m_size{0};
+
+public:
+	mapped_file() = default;
+	mapped_file(mapped_file const& other) = delete;
+	mapped_file(mapped_file&& other) noexcept;
+	mapped_file& operator=(mapped_file const& other) = delete;
+	mapped_file& operator=(mapped_file&& other) noexcept;
+	~mapped_file();
+
+	// maps the given file; returns false (and leaves errno set) on failure
+	bool open(char const* path);
+	void close();
+
+	char const* data() const { return static_cast<char const*>(m_data); }
+	char const* begin() const { return data(); }
+	char const* end() const { return data() + m_size; }
+	size_t size() const { return m_size; }
+};
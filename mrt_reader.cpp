@@ -0,0 +1,150 @@
+#include "mrt_reader.hpp"
+
+#include <cstring>
+
+namespace {
+	enum : uint16_t {
+		MRT_TABLE_DUMP_V2 = 13,
+	};
+
+	enum : uint16_t {
+		RIB_IPV4_UNICAST = 2,
+		RIB_IPV6_UNICAST = 4,
+		RIB_IPV4_UNICAST_ADDPATH = 8,
+		RIB_IPV6_UNICAST_ADDPATH = 10,
+	};
+
+	// common MRT header: timestamp, type, subtype, length
+	size_t const MRT_HEADER_LENGTH = 12;
+
+	uint16_t read_u16(unsigned char const* p) {
+		return static_cast<uint16_t>((uint16_t{p[0]} << 8) | p[1]);
+	}
+
+	uint32_t read_u32(unsigned char const* p) {
+		return (uint32_t{p[0]} << 24) | (uint32_t{p[1]} << 16) | (uint32_t{p[2]} << 8) | p[3];
+	}
+}
+
+bool mrt_rib_record::next_entry(size_t& offset, mrt_rib_entry& entry) const {
+	size_t const fixed_length = m_add_path ? 12 : 8;
+	if (offset + fixed_length > m_entries_length) return false;
+	unsigned char const* p = m_entries + offset;
+
+	entry.peer_index = read_u16(p);
+	entry.originated_time = read_u32(p + 2);
+	if (m_add_path) {
+		entry.path_id = read_u32(p + 6);
+		p += 4;
+	} else {
+		entry.path_id = 0;
+	}
+	entry.attributes_length = read_u16(p + 6);
+	entry.attributes = p + 8;
+
+	if (offset + fixed_length + entry.attributes_length > m_entries_length) return false;
+	offset += fixed_length + entry.attributes_length;
+	return true;
+}
+
+mrt_reader::mrt_reader(void const* data, size_t size)
+: m_pos(static_cast<unsigned char const*>(data)), m_end(static_cast<unsigned char const*>(data) + size) {
+}
+
+bool mrt_reader::next(mrt_rib_record& record) {
+	while (!m_error && m_pos != m_end) {
+		if (static_cast<size_t>(m_end - m_pos) < MRT_HEADER_LENGTH) {
+			m_error = true;
+			return false;
+		}
+		uint16_t const type = read_u16(m_pos + 4);
+		uint16_t const subtype = read_u16(m_pos + 6);
+		size_t const length = read_u32(m_pos + 8);
+		if (static_cast<size_t>(m_end - m_pos) - MRT_HEADER_LENGTH < length) {
+			m_error = true;
+			return false;
+		}
+		unsigned char const* body = m_pos + MRT_HEADER_LENGTH;
+		unsigned char const* const body_end = body + length;
+		m_pos = body_end;
+
+		if (MRT_TABLE_DUMP_V2 != type) continue;
+
+		bool is_ipv6;
+		switch (subtype) {
+		case RIB_IPV4_UNICAST:
+		case RIB_IPV4_UNICAST_ADDPATH:
+			is_ipv6 = false;
+			break;
+		case RIB_IPV6_UNICAST:
+		case RIB_IPV6_UNICAST_ADDPATH:
+			is_ipv6 = true;
+			break;
+		default:
+			continue;
+		}
+
+		// sequence number, prefix length, prefix, entry count
+		if (length < 5) {
+			m_error = true;
+			return false;
+		}
+		record.m_sequence = read_u32(body);
+		unsigned char const prefix_length = body[4];
+		size_t const prefix_bytes = (prefix_length + 7u) / 8u;
+		body += 5;
+		if (prefix_length > (is_ipv6 ? 128 : 32) || static_cast<size_t>(body_end - body) < prefix_bytes + 2) {
+			m_error = true;
+			return false;
+		}
+
+		unsigned char address[16] = { 0 };
+		std::memcpy(address, body, prefix_bytes);
+		body += prefix_bytes;
+		if (is_ipv6) {
+			in6_addr address6;
+			std::memcpy(address6.s6_addr, address, sizeof(address6.s6_addr));
+			record.m_prefix = ipv6_network(address6, prefix_length);
+		} else {
+			uint32_t address4;
+			std::memcpy(&address4, address, sizeof(address4));
+			record.m_prefix = ipv4_network(address4, prefix_length);
+		}
+
+		record.m_entry_count = read_u16(body);
+		body += 2;
+		record.m_add_path = (RIB_IPV4_UNICAST_ADDPATH == subtype || RIB_IPV6_UNICAST_ADDPATH == subtype);
+		record.m_entries = body;
+		record.m_entries_length = static_cast<size_t>(body_end - body);
+		return true;
+	}
+	return false;
+}
+
+bool find_bgp_attribute(unsigned char const* attributes, size_t length, unsigned char type_code, unsigned char const*& value, size_t& value_length) {
+	// extended length flag: attribute length has two bytes
+	unsigned char const EXTENDED_LENGTH = 0x10;
+
+	size_t pos = 0;
+	while (pos + 3 <= length) {
+		unsigned char const flags = attributes[pos];
+		unsigned char const type = attributes[pos + 1];
+		size_t attr_length;
+		if (0 != (flags & EXTENDED_LENGTH)) {
+			if (pos + 4 > length) return false;
+			attr_length = read_u16(attributes + pos + 2);
+			pos += 4;
+		} else {
+			attr_length = attributes[pos + 2];
+			pos += 3;
+		}
+		if (pos + attr_length > length) return false;
+		if (type == type_code) {
+			value = attributes + pos;
+			value_length = attr_length;
+			return true;
+		}
+		pos += attr_length;
+	}
+	return false;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "ip_network.hpp"
+
+#include <utility>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+// entry of a TABLE_DUMP_V2 RIB record: one path for the prefix as seen by one peer
+struct mrt_rib_entry {
+	uint16_t peer_index{0};
+	uint32_t originated_time{0};
+	// only set in RIB_*_ADDPATH records
+	uint32_t path_id{0};
+	// BGP path attributes (see find_bgp_attribute); points into the MRT data
+	unsigned char const* attributes{nullptr};
+	size_t attributes_length{0};
+};
+
+// RIB_IPV4_UNICAST / RIB_IPV6_UNICAST (and *_ADDPATH) record of a TABLE_DUMP_V2 dump (RFC 6396, RFC 8050);
+// doesn't own any data, only valid as long as the underlying MRT data is.
+class mrt_rib_record {
+private:
+	friend class mrt_reader;
+
+	ip_network m_prefix;
+	uint32_t m_sequence{0};
+	uint16_t m_entry_count{0};
+	bool m_add_path{false};
+	unsigned char const* m_entries{nullptr};
+	size_t m_entries_length{0};
+
+public:
+	ip_network const& prefix() const { return m_prefix; }
+	uint32_t sequence() const { return m_sequence; }
+	uint16_t entry_count() const { return m_entry_count; }
+
+	// decode entry at byte offset `offset` into the entries and advance offset to the next entry.
+	// start with offset 0; returns false after the last entry or if the entry is malformed.
+	bool next_entry(size_t& offset, mrt_rib_entry& entry) const;
+};
+
+// reads RIB records from MRT data (usually a mapped_file) without copying or allocating anything
+class mrt_reader {
+private:
+	unsigned char const* m_pos{nullptr};
+	unsigned char const* m_end{nullptr};
+	bool m_error{false};
+
+public:
+	explicit mrt_reader(void const* data, size_t size);
+
+	// read next unicast RIB record; skips all other records (e.g. PEER_INDEX_TABLE).
+	// returns false at the end of the data or on malformed data (see error())
+	bool next(mrt_rib_record& record);
+
+	// whether reading stopped due to malformed data
+	bool error() const { return m_error; }
+};
+
+// find BGP path attribute with given type code (e.g. 3 for NEXT_HOP) in a block of path attributes
+// returns false if not found or malformed
+bool find_bgp_attribute(unsigned char const* attributes, size_t length, unsigned char type_code, unsigned char const*& value, size_t& value_length);
+
+// loads all RIB records from reader into the tables for the respective family; `make_value(record)` creates
+// the value for a prefix. records are collected in batches of (at most) `batch_size` entries and handed to the
+// tables' range insert_or_assign; the batch buffers are the only allocations.
+// returns the number of records loaded.
+template<typename IPv4Table, typename IPv6Table, typename MakeValue>
+size_t load_mrt_rib(mrt_reader& reader, IPv4Table& ipv4_table, IPv6Table& ipv6_table, MakeValue make_value, size_t batch_size = 4096) {
+	std::vector<std::pair<ipv4_network, typename IPv4Table::value_t>> ipv4_batch;
+	std::vector<std::pair<ipv6_network, typename IPv6Table::value_t>> ipv6_batch;
+	ipv4_batch.reserve(batch_size);
+	ipv6_batch.reserve(batch_size);
+
+	size_t count = 0;
+	mrt_rib_record record;
+	while (reader.next(record)) {
+		++count;
+		if (record.prefix().is_ipv6()) {
+			ipv6_batch.emplace_back(record.prefix().ipv6(), make_value(record));
+			if (ipv6_batch.size() >= batch_size) {
+				ipv6_table.insert_or_assign(ipv6_batch.begin(), ipv6_batch.end());
+				ipv6_batch.clear();
+			}
+		} else {
+			ipv4_batch.emplace_back(record.prefix().ipv4(), make_value(record));
+			if (ipv4_batch.size() >= batch_size) {
+				ipv4_table.insert_or_assign(ipv4_batch.begin(), ipv4_batch.end());
+				ipv4_batch.clear();
+			}
+		}
+	}
+	ipv4_table.insert_or_assign(ipv4_batch.begin(), ipv4_batch.end());
+	ipv6_table.insert_or_assign(ipv6_batch.begin(), ipv6_batch.end());
+	return count;
+}
@@ -0,0 +1,186 @@
+#pragma once
+
+#include "numa_topology.hpp"
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+// read-only copies of a table (any prefix_vector, radix_tree, frozen_radix_tree or
+// compressed_prefix_vector instantiation), one per NUMA node: lookups use the copy on the node
+// of the calling thread, so threads on every socket read local memory.
+//
+// publish() builds the copies on threads bound to each node (memory is placed on the node
+// which first touches it) and then replaces all copies at once with a single pointer swap.
+// readers holding a replica() keep their copies alive until they drop them. on single node
+// systems there is only one copy, built on the calling thread.
+//
+// lookups don't touch the shared pointer: every thread caches the copy it used last (and its
+// node, resolved once, so threads should stay on their node; see
+// numa_topology::bind_current_thread) and only reloads it after a publish().
+// a thread keeps its last copy alive until its next lookup or until it exits, and the cache
+// holds one table per thread: threads alternating between several numa_replicated of the same
+// table type reload on every switch.
+template<typename Table>
+class numa_replicated {
+public:
+	typedef Table table_t;
+	typedef typename Table::key_t key_t;
+	typedef typename Table::value_t value_t;
+
+private:
+	// copies from one publish(); immutable once published
+	struct replica_set {
+		// per node
+		std::vector<std::shared_ptr<table_t const>> m_tables;
+		uint64_t m_generation{0};
+	};
+
+	// per thread: the copy used last
+	struct reader_cache {
+		// m_id of the numa_replicated (0: none)
+		uint64_t m_owner{0};
+		uint64_t m_generation{0};
+		size_t m_node{0};
+		std::shared_ptr<table_t const> m_table;
+	};
+
+	numa_topology const* m_topology;
+	// unique across all instances, unlike addresses
+	uint64_t const m_id;
+	// only accessed with std::atomic_load / std::atomic_store
+	std::shared_ptr<replica_set const> m_replicas;
+	// m_generation of m_replicas (0 before the first publish()); lets readers check for a new
+	// publish() without touching m_replicas
+	std::atomic<uint64_t> m_generation{0};
+	// serializes publish()
+	std::mutex m_publish_mutex;
+
+	std::shared_ptr<replica_set const> current() const {
+		return std::atomic_load(&m_replicas);
+	}
+
+	static uint64_t next_id() {
+		static std::atomic<uint64_t> last{0};
+		return ++last;
+	}
+
+	static reader_cache& thread_cache() {
+		static thread_local reader_cache cache;
+		return cache;
+	}
+
+	// copy for the node of the calling thread (nullptr before the first publish())
+	reader_cache const& local() const {
+		reader_cache& cache = thread_cache();
+		if (cache.m_owner != m_id) {
+			cache.m_owner = m_id;
+			cache.m_node = m_topology->current_node();
+		} else if (m_generation.load(std::memory_order_relaxed) == cache.m_generation) {
+			return cache;
+		}
+		auto const replicas = current();
+		cache.m_generation = replicas ? replicas->m_generation : 0;
+		cache.m_table = replicas ? replicas->m_tables[cache.m_node] : nullptr;
+		return cache;
+	}
+
+public:
+	explicit numa_replicated(numa_topology const& topology = numa_topology::system())
+	: m_topology(&topology), m_id(next_id()) {
+	}
+
+	numa_replicated(numa_replicated const& other) = delete;
+	numa_replicated& operator=(numa_replicated const& other) = delete;
+
+	// copies source to every node and replaces the previous copies
+	void publish(table_t const& source) {
+		std::lock_guard<std::mutex> lock(m_publish_mutex);
+		size_t const nodes = m_topology->node_count();
+		auto replicas = std::make_shared<replica_set>();
+		replicas->m_tables.resize(nodes);
+		if (1 == nodes) {
+			replicas->m_tables[0] = std::make_shared<table_t const>(source);
+		} else {
+			std::vector<std::exception_ptr> errors(nodes);
+			std::vector<std::thread> threads;
+			threads.reserve(nodes);
+			for (size_t node = 0; node < nodes; ++node) {
+				threads.emplace_back([this, &source, &replicas, &errors, node]() {
+					try {
+						// if binding fails the copy still works, only maybe on another node
+						m_topology->bind_current_thread(node);
+						replicas->m_tables[node] = std::make_shared<table_t const>(source);
+					} catch (...) {
+						errors[node] = std::current_exception();
+					}
+				});
+			}
+			for (auto& thread: threads) thread.join();
+			for (auto const& error: errors) {
+				if (error) std::rethrow_exception(error);
+			}
+		}
+
+		// only publish() writes m_generation, under m_publish_mutex
+		replicas->m_generation = m_generation.load(std::memory_order_relaxed) + 1;
+		uint64_t const generation = replicas->m_generation;
+		std::atomic_store(&m_replicas, std::shared_ptr<replica_set const>(std::move(replicas)));
+		m_generation.store(generation, std::memory_order_release);
+	}
+
+	// copy for the node of the calling thread (nullptr before the first publish())
+	std::shared_ptr<table_t const> replica() const {
+		return local().m_table;
+	}
+
+	// copy on the given node (nullptr before the first publish())
+	std::shared_ptr<table_t const> replica(size_t node) const {
+		auto const replicas = current();
+		if (!replicas) return nullptr;
+		return replicas->m_tables[node];
+	}
+
+	// copy value from entry with longest matching prefix of key (or an address, see
+	// KeyBitStringTraits::address_to_bitstring in bitstring.hpp) in the local copy into
+	// result; returns false (and leaves result alone) if there is no match
+	template<typename LookupKey>
+	bool value(LookupKey const& key, value_t& result) const {
+		table_t const* const table = local().m_table.get();
+		if (!table) return false;
+		value_t const* const v = table->value(key);
+		if (!v) return false;
+		result = *v;
+		return true;
+	}
+
+	numa_topology const& topology() const {
+		return *m_topology;
+	}
+
+	size_t node_count() const {
+		return m_topology->node_count();
+	}
+
+	// number of publish() calls whose copies are visible (0 before the first)
+	uint64_t generation() const {
+		return m_generation.load(std::memory_order_acquire);
+	}
+
+	// bytes allocated for all copies (not counting memory owned by keys or values)
+	size_t memory_usage() const {
+		size_t result = sizeof(*this);
+		auto const replicas = current();
+		if (!replicas) return result;
+		result += sizeof(replica_set) + replicas->m_tables.capacity() * sizeof(std::shared_ptr<table_t const>);
+		for (auto const& table: replicas->m_tables) result += table->memory_usage();
+		return result;
+	}
+};
@@ -0,0 +1,139 @@
+#include "numa_topology.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <utility>
+
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+
+namespace {
+	// sysfs files are small and report a bogus size; read up to a fixed limit
+	bool read_small_file(std::string const& path, std::string& result) {
+		int const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (-1 == fd) return false;
+		char buf[4096];
+		result.clear();
+		for (;;) {
+			ssize_t const n = ::read(fd, buf, sizeof(buf));
+			if (n < 0) {
+				if (EINTR == errno) continue;
+				::close(fd);
+				return false;
+			}
+			if (0 == n) break;
+			result.append(buf, static_cast<size_t>(n));
+		}
+		::close(fd);
+		return true;
+	}
+
+	bool parse_id(char const*& pos, char const* end, int& result) {
+		if (pos == end || *pos < '0' || *pos > '9') return false;
+		long value = 0;
+		for (; pos != end && *pos >= '0' && *pos <= '9'; ++pos) {
+			value = value * 10 + (*pos - '0');
+			if (value > 0xffff) return false;
+		}
+		result = static_cast<int>(value);
+		return true;
+	}
+
+	std::vector<std::vector<int>> online_cpus() {
+		long const count = sysconf(_SC_NPROCESSORS_ONLN);
+		std::vector<std::vector<int>> result(1);
+		for (long cpu = 0; cpu < std::max(count, 1L); ++cpu) result[0].push_back(static_cast<int>(cpu));
+		return result;
+	}
+}
+
+bool parse_id_list(char const* str, size_t length, std::vector<int>& result) {
+	char const* pos = str;
+	char const* end = str + length;
+	if (pos != end && '\n' == end[-1]) --end;
+	// empty list: no ids
+	while (pos != end) {
+		int first;
+		if (!parse_id(pos, end, first)) return false;
+		int last = first;
+		if (pos != end && '-' == *pos) {
+			++pos;
+			if (!parse_id(pos, end, last) || last < first) return false;
+		}
+		for (int id = first; id <= last; ++id) result.push_back(id);
+		if (pos != end) {
+			if (',' != *pos) return false;
+			++pos;
+			if (pos == end) return false;
+		}
+	}
+	return true;
+}
+
+numa_topology::numa_topology()
+: numa_topology(online_cpus()) {
+}
+
+numa_topology::numa_topology(std::vector<std::vector<int>> node_cpus) {
+	for (auto& cpus: node_cpus) {
+		if (cpus.empty()) continue;
+		size_t const node = m_node_cpus.size();
+		for (int cpu: cpus) {
+			if (cpu < 0) continue;
+			if (static_cast<size_t>(cpu) >= m_cpu_nodes.size()) m_cpu_nodes.resize(static_cast<size_t>(cpu) + 1, 0);
+			m_cpu_nodes[static_cast<size_t>(cpu)] = node;
+		}
+		m_node_cpus.push_back(std::move(cpus));
+	}
+	if (m_node_cpus.empty()) *this = numa_topology();
+}
+
+numa_topology const& numa_topology::system() {
+	static numa_topology const topology = read("/sys/devices/system/node");
+	return topology;
+}
+
+numa_topology numa_topology::read(char const* sysfs_node_dir) {
+	std::string const dir(sysfs_node_dir);
+	std::string content;
+	std::vector<int> nodes;
+	if (!read_small_file(dir + "/online", content) || !parse_id_list(content.data(), content.size(), nodes)) return numa_topology();
+
+	std::vector<std::vector<int>> node_cpus;
+	for (int node: nodes) {
+		std::vector<int> cpus;
+		if (!read_small_file(dir + "/node" + std::to_string(node) + "/cpulist", content) || !parse_id_list(content.data(), content.size(), cpus)) return numa_topology();
+		node_cpus.push_back(std::move(cpus));
+	}
+	return numa_topology(std::move(node_cpus));
+}
+
+size_t numa_topology::node_of_cpu(int cpu) const {
+	if (cpu < 0 || static_cast<size_t>(cpu) >= m_cpu_nodes.size()) return 0;
+	return m_cpu_nodes[static_cast<size_t>(cpu)];
+}
+
+size_t numa_topology::current_node() const {
+	if (1 == m_node_cpus.size()) return 0;
+	return node_of_cpu(sched_getcpu());
+}
+
+bool numa_topology::bind_current_thread(size_t node) const {
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	for (int cpu: m_node_cpus[node]) {
+		if (cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+	}
+	return 0 == sched_setaffinity(0, sizeof(set), &set);
+}
+
+std::string to_string(numa_topology const& topology) {
+	std::string result;
+	for (size_t node = 0; node < topology.node_count(); ++node) {
+		if (0 != node) result += "; ";
+		result += "node " + std::to_string(node) + ":";
+		for (int cpu: topology.cpus(node)) result += " " + std::to_string(cpu);
+	}
+	return result;
+}
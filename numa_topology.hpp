@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <stddef.h>
+
+// NUMA nodes (with cpus) of the system as reported by sysfs (/sys/devices/system/node).
+// without that information (non-NUMA kernels, containers without sysfs) there is a single
+// node with all online cpus.
+//
+// nodes are numbered densely from 0; memory-only nodes are left out (no thread can run
+// there to place a copy of a table).
+class numa_topology {
+private:
+	// cpu ids per node
+	std::vector<std::vector<int>> m_node_cpus;
+	// node per cpu id (index: cpu id)
+	std::vector<size_t> m_cpu_nodes;
+
+public:
+	// single node with all online cpus
+	numa_topology();
+	// given cpu ids per node (empty nodes are left out)
+	explicit numa_topology(std::vector<std::vector<int>> node_cpus);
+
+	// topology of the running system (read once)
+	static numa_topology const& system();
+
+	// reads the topology from a sysfs node directory (falls back to a single node)
+	static numa_topology read(char const* sysfs_node_dir);
+
+	size_t node_count() const { return m_node_cpus.size(); }
+
+	std::vector<int> const& cpus(size_t node) const { return m_node_cpus[node]; }
+
+	// node of a cpu id (0 for unknown cpus)
+	size_t node_of_cpu(int cpu) const;
+
+	// node of the cpu the calling thread currently runs on (0 if unknown)
+	size_t current_node() const;
+
+	// restricts the calling thread to the cpus of the given node; returns false (and leaves
+	// errno set) on failure
+	bool bind_current_thread(size_t node) const;
+};
+
+// parses a sysfs cpu or node list ("0-3,8-11", optionally followed by a newline) and appends
+// the ids to result. returns false on malformed input
+bool parse_id_list(char const* str, size_t length, std::vector<int>& result);
+
+std::string to_string(numa_topology const& topology);
@@ -1,18 +1,32 @@
 #pragma once
 
+#include "bitstring.hpp"
+#include "instrumentation.hpp"
 #include "iterator_range.hpp"
+#include "table_generation.hpp"
 
 #include <algorithm>
 #include <functional>
-#include <vector>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
 
 #include <cassert>
 
-template<typename Key, typename Value, typename KeyBitStringTraits>
+#include <boost/container/vector.hpp>
+
+// Allocator: allocator for the entries (rebound to the internal element type); any standard
+// allocator works, e.g. polymorphic allocators (std::pmr or boost::container::pmr) or arenas.
+// entries refer to their ancestors by index and are stored in a boost::container::vector, which
+// supports "fancy" pointers: with boost::interprocess::allocator (offset_ptr) the table can be
+// built in a shared memory segment and used by all processes mapping it, at any address (as long
+// as Key and Value don't contain pointers).
+template<typename Key, typename Value, typename KeyBitStringTraits, typename Allocator = std::allocator<Value>>
 class prefix_vector {
 public:
 	typedef Key key_t;
 	typedef Value value_t;
+	typedef Allocator allocator_type;
 
 private:
 	static constexpr size_t NO_ANCESTOR{~size_t{0}};
@@ -29,15 +43,32 @@ private:
 		explicit inner_element_t(ArgKey&& key, ArgValue&& value, size_t ancestor)
 		: m_ancestor(ancestor), m_key(std::forward<ArgKey>(key)), m_value(std::forward<ArgValue>(value)) {
 		}
+
+		// value constructed from args
+		struct emplace_tag {};
+		template<typename ArgKey, typename... Args>
+		explicit inner_element_t(emplace_tag, size_t ancestor, ArgKey&& key, Args&&... args)
+		: m_ancestor(ancestor), m_key(std::forward<ArgKey>(key)), m_value(std::forward<Args>(args)...) {
+		}
 	};
 
-	typedef std::vector<inner_element_t> container_t;
+	typedef boost::container::vector<inner_element_t, typename std::allocator_traits<Allocator>::template rebind_alloc<inner_element_t>> container_t;
 	typedef typename container_t::iterator inner_iterator;
 	typedef typename container_t::const_iterator const_inner_iterator;
 	typedef typename KeyBitStringTraits::bitstring bitstring;
 	container_t m_container;
+	table_generation m_generation;
 
 public:
+	prefix_vector() = default;
+	explicit prefix_vector(allocator_type const& allocator)
+	: m_container(typename container_t::allocator_type(allocator)) {
+	}
+
+	allocator_type get_allocator() const {
+		return allocator_type(m_container.get_allocator());
+	}
+
 	// public visible "entry" type
 	class iterator;
 	class const_iterator;
@@ -48,6 +79,10 @@ public:
 		friend class iterator;
 		friend class const_iterator;
 		friend class prefix_vector;
+		template<typename, typename>
+		friend class base_covering_iterator;
+		template<typename, typename>
+		friend class base_overlapping_iterator;
 
 	public:
 		explicit element_type() = default;
@@ -94,6 +129,10 @@ public:
 		const_inner_iterator m_elem;
 		friend class const_iterator;
 		friend class prefix_vector;
+		template<typename, typename>
+		friend class base_covering_iterator;
+		template<typename, typename>
+		friend class base_overlapping_iterator;
 
 	public:
 		explicit const_element_type() = default;
@@ -138,6 +177,81 @@ public:
 		friend bool operator!=(const_iterator a, const_iterator b) { return a.m_inner != b.m_inner; }
 	};
 
+	// follows the ancestor chain of an entry (towards shorter keys)
+	template<typename Element, typename InnerIterator>
+	class base_covering_iterator : public std::iterator<std::forward_iterator_tag, Element> {
+	private:
+		friend class prefix_vector;
+
+		mutable Element m_inner;
+		InnerIterator m_begin;
+		InnerIterator m_end;
+
+		explicit base_covering_iterator(InnerIterator const& elem, InnerIterator const& begin, InnerIterator const& end)
+		: m_inner(elem), m_begin(begin), m_end(end) {
+		}
+
+		void next() {
+			size_t const ancestor = m_inner.m_elem->m_ancestor;
+			m_inner.m_elem = (NO_ANCESTOR == ancestor) ? m_end : m_begin + static_cast<std::ptrdiff_t>(ancestor);
+		}
+
+	public:
+		explicit base_covering_iterator() = default;
+
+		Element& operator*() const { return m_inner; }
+		Element* operator->() const { return &m_inner; }
+
+		base_covering_iterator& operator++() { next(); return *this; }
+		base_covering_iterator operator++(int) { base_covering_iterator result{*this}; next(); return result; }
+
+		friend bool operator==(base_covering_iterator const& a, base_covering_iterator const& b) { return a.m_inner == b.m_inner; }
+		friend bool operator!=(base_covering_iterator const& a, base_covering_iterator const& b) { return a.m_inner != b.m_inner; }
+	};
+
+	typedef base_covering_iterator<element_type, inner_iterator> covering_iterator;
+	typedef base_covering_iterator<const_element_type, const_inner_iterator> const_covering_iterator;
+
+	// first follows the ancestor chain of an entry, then iterates over a contiguous range
+	// (all ancestors come before the contiguous range in the container)
+	template<typename Element, typename InnerIterator>
+	class base_overlapping_iterator : public std::iterator<std::forward_iterator_tag, Element> {
+	private:
+		friend class prefix_vector;
+
+		mutable Element m_inner;
+		InnerIterator m_begin;
+		InnerIterator m_range_begin;
+
+		explicit base_overlapping_iterator(InnerIterator const& elem, InnerIterator const& begin, InnerIterator const& range_begin)
+		: m_inner(elem), m_begin(begin), m_range_begin(range_begin) {
+		}
+
+		void next() {
+			if (m_inner.m_elem < m_range_begin) {
+				size_t const ancestor = m_inner.m_elem->m_ancestor;
+				m_inner.m_elem = (NO_ANCESTOR == ancestor) ? m_range_begin : m_begin + static_cast<std::ptrdiff_t>(ancestor);
+			} else {
+				++m_inner.m_elem;
+			}
+		}
+
+	public:
+		explicit base_overlapping_iterator() = default;
+
+		Element& operator*() const { return m_inner; }
+		Element* operator->() const { return &m_inner; }
+
+		base_overlapping_iterator& operator++() { next(); return *this; }
+		base_overlapping_iterator operator++(int) { base_overlapping_iterator result{*this}; next(); return result; }
+
+		friend bool operator==(base_overlapping_iterator const& a, base_overlapping_iterator const& b) { return a.m_inner == b.m_inner; }
+		friend bool operator!=(base_overlapping_iterator const& a, base_overlapping_iterator const& b) { return a.m_inner != b.m_inner; }
+	};
+
+	typedef base_overlapping_iterator<element_type, inner_iterator> overlapping_iterator;
+	typedef base_overlapping_iterator<const_element_type, const_inner_iterator> const_overlapping_iterator;
+
 private:
 	static bitstring getBitString(key_t const& key) {
 		KeyBitStringTraits keyBitStringTraits{};
@@ -146,11 +260,13 @@ private:
 
 	struct compare_keys {
 		bool operator()(inner_element_t const& a, bitstring const& b) {
+			PREFIX_TABLE_COUNT(key_compares, 1);
 			bitstring const a_bitstring = getBitString(a.m_key);
 			return is_lexicographic_less(a_bitstring, b);
 		}
 
 		bool operator()(bitstring const& a, inner_element_t const& b) {
+			PREFIX_TABLE_COUNT(key_compares, 1);
 			bitstring const b_bitstring = getBitString(b.m_key);
 			return is_lexicographic_less(a, b_bitstring);
 		}
@@ -180,11 +296,9 @@ private:
 	}
 
 	// find closest ancestor (-> ancestor with longest key) of key, starting with insert position "pos"
-	size_t find_ancestor_index(const_inner_iterator pos, key_t const& key) const {
+	size_t find_ancestor_index(const_inner_iterator pos, bitstring const& k) const {
 		if (m_container.empty()) return NO_ANCESTOR;
 
-		bitstring const k = getBitString(key);
-
 		size_t current = static_cast<size_t>(pos - m_container.begin());
 
 		// the insert position could actually be an exact match:
@@ -199,6 +313,7 @@ private:
 
 		for (;;) {
 			// invariant: m_container.begin() <= pos < m_container.end()
+			PREFIX_TABLE_COUNT(ancestor_hops, 1);
 			if (is_prefix(getBitString(m_container[current].m_key), k)) return current; // prefix match
 			if (NO_ANCESTOR == m_container[current].m_ancestor) return NO_ANCESTOR;
 			assert(m_container[current].m_ancestor < current);
@@ -206,20 +321,21 @@ private:
 		}
 	}
 
-	const_inner_iterator find_ancestor(const_inner_iterator pos, key_t const& key) const {
-		size_t ndx = find_ancestor_index(pos, key);
+	const_inner_iterator find_ancestor(const_inner_iterator pos, bitstring const& k) const {
+		size_t ndx = find_ancestor_index(pos, k);
 		if (NO_ANCESTOR == ndx) return m_container.end();
 		return m_container.begin() + ndx;
 	}
 
 	// find node with longest common prefix for key
-	const_inner_iterator lookup(key_t const& key) const {
-		const_inner_iterator insert_pos = std::lower_bound(m_container.begin(), m_container.end(), getBitString(key), compare_keys{});
-		return find_ancestor(insert_pos, key);
+	const_inner_iterator lookup(bitstring const& k) const {
+		PREFIX_TABLE_COUNT(vector_lookups, 1);
+		const_inner_iterator insert_pos = std::lower_bound(m_container.begin(), m_container.end(), k, compare_keys{});
+		return find_ancestor(insert_pos, k);
 	}
 
-	const_inner_iterator lookup_exact(key_t const& key) const {
-		bitstring const k = getBitString(key);
+	const_inner_iterator lookup_exact(bitstring const& k) const {
+		PREFIX_TABLE_COUNT(vector_lookups, 1);
 		const_inner_iterator insert_pos = std::lower_bound(m_container.begin(), m_container.end(), k, compare_keys{});
 		if (m_container.end() == insert_pos || k != getBitString(insert_pos->m_key)) return m_container.end();
 		return insert_pos;
@@ -233,29 +349,54 @@ private:
 		return make_iterator_range(from, to);
 	}
 
-	std::pair<iterator, bool>  intern_insert(key_t& key, value_t& value, bool overwrite) {
-		bitstring const k = getBitString(key);
+	struct overlapping_bounds {
+		// first entry of the ancestor chain (range_begin if there is no ancestor)
+		const_inner_iterator first;
+		const_inner_iterator range_begin;
+		const_inner_iterator range_end;
+	};
 
-		inner_iterator pos = std::lower_bound(m_container.begin(), m_container.end(), k, compare_keys{});
-		if (m_container.end() != pos && k == getBitString(pos->m_key)) {
-			if (!overwrite) return std::pair<iterator, bool>(iterator(pos), false);
-			pos->m_value = std::move(value);
-			return std::pair<iterator, bool>(iterator(pos), true);
+	overlapping_bounds intern_overlapping(key_t const& lo, key_t const& hi) const {
+		bitstring const lo_bs = getBitString(lo);
+		bitstring const hi_bs = getBitString(hi);
+		if (is_lexicographic_less(hi_bs, lo_bs)) return overlapping_bounds{m_container.end(), m_container.end(), m_container.end()};
+
+		const_inner_iterator const range_begin = std::lower_bound(m_container.begin(), m_container.end(), lo_bs, compare_keys{});
+		const_inner_iterator const range_end = std::upper_bound(range_begin, m_container.end(), hi_bs, compare_keys{});
+		// only "real" prefixes of lo; an exact match is part of the range
+		size_t ancestor;
+		if (m_container.end() != range_begin && lo_bs == getBitString(range_begin->m_key)) {
+			ancestor = range_begin->m_ancestor;
+		} else {
+			ancestor = find_ancestor_index(range_begin, lo_bs);
 		}
+		const_inner_iterator const first = (NO_ANCESTOR == ancestor) ? range_begin : m_container.begin() + static_cast<std::ptrdiff_t>(ancestor);
+		return overlapping_bounds{first, range_begin, range_end};
+	}
 
+	// insert a new element (key not present yet) at pos, which must be the lower bound for k;
+	// the element is constructed from args before anything is modified. args may move the key
+	// k points into: only the key of the new element is used afterwards
+	template<typename... Args>
+	inner_iterator intern_emplace(inner_iterator pos, bitstring const& k, Args&&... args) {
 		size_t new_index = static_cast<size_t>(pos - m_container.begin());
 		// next "valid" ancestor of new element
-		auto ancestor_index = find_ancestor_index(pos, key);
+		auto ancestor_index = find_ancestor_index(pos, k);
+		inner_element_t new_elem(typename inner_element_t::emplace_tag{}, ancestor_index, std::forward<Args>(args)...);
+		bitstring const new_k = getBitString(new_elem.m_key);
+		m_generation.bump();
+
 		// we insert a new element at [new_index]. all indices >= new_index need to be incremented:
 		assert(NO_ANCESTOR == ancestor_index || ancestor_index < new_index);
 		// first come all the nodes which are possible in the subtree of the new element
 		// if they end there won't be any more
 		// only in this subtree do we replace the old ancestor with the new index
 		bool possibly_in_new_subtree = true;
+		PREFIX_TABLE_COUNT(insert_fixup_elements, static_cast<size_t>(m_container.end() - pos));
 		for (auto& elem: make_iterator_range(pos, m_container.end())) {
 			if (elem.m_ancestor == ancestor_index) {
 				if (possibly_in_new_subtree) {
-					possibly_in_new_subtree = is_prefix(k, getBitString(elem.m_key));
+					possibly_in_new_subtree = is_prefix(new_k, getBitString(elem.m_key));
 					if (possibly_in_new_subtree) elem.m_ancestor = new_index;
 				}
 			} else if (NO_ANCESTOR != elem.m_ancestor && elem.m_ancestor >= new_index) {
@@ -263,13 +404,144 @@ private:
 			}
 		}
 
-		pos = m_container.insert(pos, inner_element_t{std::move(key), std::move(value), ancestor_index});
+		return m_container.insert(pos, std::move(new_elem));
+	}
+
+	std::pair<iterator, bool>  intern_insert(key_t& key, value_t& value, bool overwrite) {
+		PREFIX_TABLE_COUNT(vector_inserts, 1);
+		bitstring const k = getBitString(key);
+
+		inner_iterator pos = std::lower_bound(m_container.begin(), m_container.end(), k, compare_keys{});
+		if (m_container.end() != pos && k == getBitString(pos->m_key)) {
+			if (!overwrite) return std::pair<iterator, bool>(iterator(pos), false);
+			m_generation.bump();
+			pos->m_value = std::move(value);
+			return std::pair<iterator, bool>(iterator(pos), true);
+		}
 
+		pos = intern_emplace(pos, k, std::move(key), std::move(value));
 		return std::pair<iterator, bool>(iterator(pos), true);
 	}
 
+	// lower bound for k, starting with a guess (which should be the lower bound or end())
+	inner_iterator intern_lower_bound(const_inner_iterator hint, bitstring const& k) {
+		// hint is correct if the previous element is less and the hint isn't
+		bool const after_prev = (hint == m_container.begin()) || is_lexicographic_less(getBitString(std::prev(hint)->m_key), k);
+		bool const before_hint = (hint == m_container.end()) || !is_lexicographic_less(getBitString(hint->m_key), k);
+		if (after_prev && before_hint) return mut_it(hint);
+		return std::lower_bound(m_container.begin(), m_container.end(), k, compare_keys{});
+	}
+
+	template<typename... Args>
+	std::pair<iterator, bool> intern_try_emplace(inner_iterator pos, bitstring const& k, key_t const& key, Args&&... args) {
+		PREFIX_TABLE_COUNT(vector_inserts, 1);
+		if (m_container.end() != pos && k == getBitString(pos->m_key)) return std::pair<iterator, bool>(iterator(pos), false);
+		return std::pair<iterator, bool>(iterator(intern_emplace(pos, k, key, std::forward<Args>(args)...)), true);
+	}
+
+	// recalculate m_ancestor for all elements in [from, to)
+	// (the ancestors of all elements before `from` must be correct)
+	void rebuild_ancestors(size_t from, size_t to) {
+		for (size_t current = from; current < to; ++current) {
+			bitstring const k = getBitString(m_container[current].m_key);
+			// same search as in find_ancestor_index
+			size_t ancestor = (0 == current) ? NO_ANCESTOR : current - 1;
+			PREFIX_TABLE_COUNT(insert_fixup_elements, 1);
+			while (NO_ANCESTOR != ancestor && !is_prefix(getBitString(m_container[ancestor].m_key), k)) {
+				PREFIX_TABLE_COUNT(ancestor_hops, 1);
+				ancestor = m_container[ancestor].m_ancestor;
+			}
+			m_container[current].m_ancestor = ancestor;
+		}
+	}
+
+	static bool less_keys(inner_element_t const& a, inner_element_t const& b) {
+		return is_lexicographic_less(getBitString(a.m_key), getBitString(b.m_key));
+	}
+
+	static bool equal_keys(inner_element_t const& a, inner_element_t const& b) {
+		return getBitString(a.m_key) == getBitString(b.m_key);
+	}
+
+	// sort batch and remove duplicate keys: keep the first entry, or the last one when overwriting
+	static void sort_batch(container_t& batch, bool overwrite) {
+		std::stable_sort(batch.begin(), batch.end(), less_keys);
+		if (overwrite) std::reverse(batch.begin(), batch.end());
+		batch.erase(std::unique(batch.begin(), batch.end(), equal_keys), batch.end());
+		if (overwrite) std::reverse(batch.begin(), batch.end());
+	}
+
+	// insert all elements from batch (in any order, might contain duplicates);
+	// merges the sorted batch into the container and then fixes all ancestors in a single pass.
+	void intern_insert_batch(container_t& batch, bool overwrite) {
+		m_generation.bump();
+		sort_batch(batch, overwrite);
+
+		// handle keys already present in the container
+		size_t new_count = 0;
+		{
+			inner_iterator pos = m_container.begin();
+			for (auto& elem: batch) {
+				pos = std::lower_bound(pos, m_container.end(), getBitString(elem.m_key), compare_keys{});
+				if (m_container.end() != pos && equal_keys(*pos, elem)) {
+					if (overwrite) pos->m_value = std::move(elem.m_value);
+				} else {
+					if (&batch[new_count] != &elem) batch[new_count] = std::move(elem);
+					++new_count;
+				}
+			}
+			batch.resize(new_count);
+		}
+		if (batch.empty()) return;
+
+		// merge from the back into the enlarged container
+		size_t old_pos = m_container.size();
+		size_t batch_pos = batch.size();
+		m_container.resize(m_container.size() + batch.size());
+		size_t write_pos = m_container.size();
+		while (batch_pos > 0) {
+			if (old_pos > 0 && less_keys(batch[batch_pos - 1], m_container[old_pos - 1])) {
+				m_container[--write_pos] = std::move(m_container[--old_pos]);
+			} else {
+				m_container[--write_pos] = std::move(batch[--batch_pos]);
+			}
+		}
+
+		// everything before write_pos didn't move
+		rebuild_ancestors(write_pos, m_container.size());
+	}
+
+	// replace the elements in [from, to) with the (sorted, unique) batch, which must fit into
+	// the same position; shifts the following elements at most once and only recalculates the
+	// ancestors of the new elements.
+	void intern_replace_range(size_t from, size_t to, container_t& batch) {
+		m_generation.bump();
+		size_t const old_count = to - from;
+		size_t const new_count = batch.size();
+		size_t const common = std::min(old_count, new_count);
+		for (size_t i = 0; i < common; ++i) m_container[from + i] = std::move(batch[i]);
+		if (new_count < old_count) {
+			m_container.erase(m_container.begin() + static_cast<std::ptrdiff_t>(from + common), m_container.begin() + static_cast<std::ptrdiff_t>(to));
+		} else if (new_count > old_count) {
+			m_container.insert(m_container.begin() + static_cast<std::ptrdiff_t>(to),
+				std::make_move_iterator(batch.begin() + static_cast<std::ptrdiff_t>(common)),
+				std::make_move_iterator(batch.end()));
+		}
+
+		// the ancestors of the following elements are before `from` or follow the range too
+		size_t const new_to = from + new_count;
+		PREFIX_TABLE_COUNT(erase_fixup_elements, m_container.size() - new_to);
+		for (size_t current = new_to; current < m_container.size(); ++current) {
+			size_t& ancestor = m_container[current].m_ancestor;
+			if (NO_ANCESTOR != ancestor && ancestor >= to) ancestor = ancestor - to + new_to;
+		}
+		rebuild_ancestors(from, new_to);
+	}
+
 	// erase element at given position; return iterator for the (previously) following entry
 	inner_iterator intern_erase(inner_iterator pos) {
+		PREFIX_TABLE_COUNT(vector_erases, 1);
+		m_generation.bump();
 		size_t old_index = static_cast<size_t>(pos - m_container.begin());
 		size_t ancestor_index = pos->m_ancestor;
 		bitstring const k = getBitString(pos->m_key);
@@ -280,6 +552,7 @@ private:
 		// if they end there won't be any more
 		// only in this subtree do we replace the old index with the ancestor
 		bool possibly_in_old_subtree = true;
+		PREFIX_TABLE_COUNT(erase_fixup_elements, static_cast<size_t>(m_container.end() - pos));
 		for (auto& elem: make_iterator_range(pos, m_container.end())) {
 			if (elem.m_ancestor == old_index) {
 				if (possibly_in_old_subtree) {
@@ -299,33 +572,99 @@ private:
 public:
 	// find entry with longest matching prefix of key (or end())
 	const_iterator find(key_t const& key) const {
-		return const_iterator(lookup(key));
+		return const_iterator(lookup(getBitString(key)));
 	}
 
 	iterator find(key_t const& key) {
-		return iterator(mut_it(lookup(key)));
+		return iterator(mut_it(lookup(getBitString(key))));
 	}
 
 	// find entry with key equal to given key (compares with bitstring)
 	const_iterator find_exact(key_t const& key) const {
-		return const_iterator(lookup_exact(key));
+		return const_iterator(lookup_exact(getBitString(key)));
 	}
 
 	iterator find_exact(key_t const& key) {
-		return iterator(mut_it(lookup_exact(key)));
+		return iterator(mut_it(lookup_exact(getBitString(key))));
 	}
 
 	// value from entry found with find() or nullptr
 	value_t const* value(key_t const& key) const {
-		auto pos = lookup(key);
+		auto pos = lookup(getBitString(key));
 		return pos == m_container.end() ? nullptr : &pos ->m_value;
 	}
 
 	value_t* value(key_t const& key) {
-		auto pos = lookup(key);
+		auto pos = lookup(getBitString(key));
 		return pos == m_container.end() ? nullptr : &mut_it(pos) ->m_value;
 	}
 
+	// find(), find_exact() and value() by address (see KeyBitStringTraits::address_to_bitstring
+	// in bitstring.hpp) or by bitstring; no key object is constructed
+	template<typename Address, typename = decltype(traits_address_to_bitstring<KeyBitStringTraits>(std::declval<Address const&>()))>
+	const_iterator find(Address const& address) const {
+		return const_iterator(lookup(traits_address_to_bitstring<KeyBitStringTraits>(address)));
+	}
+
+	template<typename Address, typename = decltype(traits_address_to_bitstring<KeyBitStringTraits>(std::declval<Address const&>()))>
+	iterator find(Address const& address) {
+		return iterator(mut_it(lookup(traits_address_to_bitstring<KeyBitStringTraits>(address))));
+	}
+
+	template<typename Address, typename = decltype(traits_address_to_bitstring<KeyBitStringTraits>(std::declval<Address const&>()))>
+	const_iterator find_exact(Address const& address) const {
+		return const_iterator(lookup_exact(traits_address_to_bitstring<KeyBitStringTraits>(address)));
+	}
+
+	template<typename Address, typename = decltype(traits_address_to_bitstring<KeyBitStringTraits>(std::declval<Address const&>()))>
+	iterator find_exact(Address const& address) {
+		return iterator(mut_it(lookup_exact(traits_address_to_bitstring<KeyBitStringTraits>(address))));
+	}
+
+	template<typename Address, typename = decltype(traits_address_to_bitstring<KeyBitStringTraits>(std::declval<Address const&>()))>
+	value_t const* value(Address const& address) const {
+		auto pos = lookup(traits_address_to_bitstring<KeyBitStringTraits>(address));
+		return pos == m_container.end() ? nullptr : &pos ->m_value;
+	}
+
+	template<typename Address, typename = decltype(traits_address_to_bitstring<KeyBitStringTraits>(std::declval<Address const&>()))>
+	value_t* value(Address const& address) {
+		auto pos = lookup(traits_address_to_bitstring<KeyBitStringTraits>(address));
+		return pos == m_container.end() ? nullptr : &mut_it(pos) ->m_value;
+	}
+
+	// all entries with a key that is a prefix of the given key, from the longest to the shortest key.
+	// the first entry is the one find() returns; the others are reached through the ancestor chain.
+	iterator_range<const_covering_iterator> covering(key_t const& key) const {
+		const_inner_iterator const pos = lookup(getBitString(key));
+		return make_iterator_range(
+			const_covering_iterator(pos, m_container.begin(), m_container.end()),
+			const_covering_iterator(m_container.end(), m_container.begin(), m_container.end()));
+	}
+	iterator_range<covering_iterator> covering(key_t const& key) {
+		inner_iterator const pos = mut_it(lookup(getBitString(key)));
+		return make_iterator_range(
+			covering_iterator(pos, m_container.begin(), m_container.end()),
+			covering_iterator(m_container.end(), m_container.begin(), m_container.end()));
+	}
+
+	// all entries intersecting the address interval [lo, hi]: the entries with a key that is a
+	// "real" prefix of lo (from the longest to the shortest key), followed by all entries with a
+	// key between lo and hi (in lexicographic order).
+	// lo and hi are compared as bitstrings; use full length keys for an address interval.
+	iterator_range<const_overlapping_iterator> overlapping(key_t const& lo, key_t const& hi) const {
+		overlapping_bounds const b = intern_overlapping(lo, hi);
+		return make_iterator_range(
+			const_overlapping_iterator(b.first, m_container.begin(), b.range_begin),
+			const_overlapping_iterator(b.range_end, m_container.begin(), b.range_begin));
+	}
+	iterator_range<overlapping_iterator> overlapping(key_t const& lo, key_t const& hi) {
+		overlapping_bounds const b = intern_overlapping(lo, hi);
+		return make_iterator_range(
+			overlapping_iterator(mut_it(b.first), m_container.begin(), mut_it(b.range_begin)),
+			overlapping_iterator(mut_it(b.range_end), m_container.begin(), mut_it(b.range_begin)));
+	}
+
 	// range with all elements prefixed by given prefix
 	iterator_range<const_iterator> subkeys(key_t const& prefix) const {
 		auto r = subtree_range(prefix);
@@ -346,6 +685,45 @@ public:
 		return intern_insert(key, value, true);
 	}
 
+	// insert with value constructed from args, but only if key isn't present yet (then nothing
+	// is constructed, and the args aren't touched)
+	template<typename... Args>
+	std::pair<iterator, bool> try_emplace(key_t const& key, Args&&... args) {
+		bitstring const k = getBitString(key);
+		inner_iterator const pos = std::lower_bound(m_container.begin(), m_container.end(), k, compare_keys{});
+		return intern_try_emplace(pos, k, key, std::forward<Args>(args)...);
+	}
+
+	// try_emplace() with a hint: the position just after where key goes, i.e. the first entry
+	// with a key greater than key or end() (like std::map::emplace_hint; end() when inserting
+	// keys in order). a good hint saves the search, a wrong one only costs that saving.
+	// returns the entry with key (the new or the already present one)
+	template<typename... Args>
+	iterator emplace_hint(const_iterator hint, key_t const& key, Args&&... args) {
+		bitstring const k = getBitString(key);
+		inner_iterator const pos = intern_lower_bound(hint->m_elem, k);
+		return intern_try_emplace(pos, k, key, std::forward<Args>(args)...).first;
+	}
+
+	// insert all (key, value) pairs from the given range, but don't overwrite existing entries
+	// (the first pair wins for duplicate keys in the range).
+	// faster than single inserts for larger ranges: the range is sorted and merged in one pass.
+	template<typename InputIterator>
+	void insert(InputIterator first, InputIterator last) {
+		container_t batch(m_container.get_allocator());
+		for (; first != last; ++first) batch.emplace_back(first->first, first->second, NO_ANCESTOR);
+		intern_insert_batch(batch, false);
+	}
+
+	// insert, or assign if key is already present, all (key, value) pairs from the given range
+	// (the last pair wins for duplicate keys in the range)
+	template<typename InputIterator>
+	void insert_or_assign(InputIterator first, InputIterator last) {
+		container_t batch(m_container.get_allocator());
+		for (; first != last; ++first) batch.emplace_back(first->first, first->second, NO_ANCESTOR);
+		intern_insert_batch(batch, true);
+	}
+
 	// erase element at given position; return iterator for the (previously) following entry
 	iterator erase(const_iterator it) {
 		return iterator(intern_erase(mut_it(it->m_elem)));
@@ -354,17 +732,67 @@ public:
 
 	// erase element with given key. returns how many elements were deleted (0 or 1)
 	size_t erase(key_t const& key) {
-		const_inner_iterator pos = lookup_exact(key);
+		const_inner_iterator pos = lookup_exact(getBitString(key));
 		if (pos == m_container.end()) return 0;
 		intern_erase(mut_it(pos));
 		return 1;
 	}
 
+	// erase all elements prefixed by given prefix (the range subkeys() returns) at once.
+	// returns how many elements were deleted
+	size_t erase_subkeys(key_t const& prefix) {
+		auto const r = subtree_range(prefix);
+		size_t const from = static_cast<size_t>(r.begin() - m_container.begin());
+		size_t const to = static_cast<size_t>(r.end() - m_container.begin());
+		if (from == to) return 0;
+		container_t batch(m_container.get_allocator());
+		intern_replace_range(from, to, batch);
+		return to - from;
+	}
+
+	// replace all elements prefixed by given prefix with the (key, value) pairs from the given
+	// range (in any order; the last pair wins for duplicate keys). throws std::invalid_argument
+	// (and leaves the table unchanged) if a key in the range isn't prefixed by prefix.
+	template<typename InputIterator>
+	void replace_subkeys(key_t const& prefix, InputIterator first, InputIterator last) {
+		container_t batch(m_container.get_allocator());
+		for (; first != last; ++first) batch.emplace_back(first->first, first->second, NO_ANCESTOR);
+		bitstring const prefix_bs = getBitString(prefix);
+		for (auto const& elem: batch) {
+			if (!is_prefix(prefix_bs, getBitString(elem.m_key))) throw std::invalid_argument("prefix_vector: key not prefixed by prefix in replace_subkeys");
+		}
+		sort_batch(batch, true);
+		auto const r = subtree_range(prefix);
+		intern_replace_range(
+			static_cast<size_t>(r.begin() - m_container.begin()),
+			static_cast<size_t>(r.end() - m_container.begin()),
+			batch);
+	}
+
 	// standard routines
 
+	bool empty() const {
+		return m_container.empty();
+	}
+
+	size_t size() const {
+		return m_container.size();
+	}
+
+	// bytes allocated for the table itself (not counting memory owned by keys or values)
+	size_t memory_usage() const {
+		return sizeof(*this) + m_container.capacity() * sizeof(inner_element_t);
+	}
+
+	// changes on every modification of the table (see table_generation)
+	uint64_t generation() const {
+		return m_generation.value();
+	}
+
 	friend void swap(prefix_vector& a, prefix_vector& b) {
 		using std::swap;
 		swap(a.m_container, b.m_container);
+		swap(a.m_generation, b.m_generation);
 	}
 
 	iterator begin() { return iterator(m_container.begin()); }
@@ -374,3 +802,6 @@ public:
 	const_iterator cbegin() const { return const_iterator(m_container.begin()); }
 	const_iterator cend() const { return const_iterator(m_container.end()); }
 };
+
+template<typename Key, typename Value, typename KeyBitStringTraits, typename Allocator>
+constexpr size_t prefix_vector<Key, Value, KeyBitStringTraits, Allocator>::NO_ANCESTOR;
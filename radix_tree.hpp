@@ -1,22 +1,43 @@
 #pragma once
 
+#include "bitstring.hpp"
+#include "frozen_radix_tree.hpp"
+#include "instrumentation.hpp"
+#include "table_generation.hpp"
+
 #include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include <cassert>
 
 #include <boost/iterator/iterator_facade.hpp>
 #include <boost/range/iterator_range.hpp>
 
-template<typename Key, typename Value, typename KeyBitStringTraits>
+// Allocator: allocator for nodes and values (rebound to the internal node type); any standard
+// allocator with raw pointers works, e.g. polymorphic allocators (std::pmr or
+// boost::container::pmr) or arenas. nodes link to each other with raw pointers, so the tree can't
+// be shared between processes; use prefix_vector for that.
+// the allocator is never propagated by assignment; swap requires equal allocators.
+template<typename Key, typename Value, typename KeyBitStringTraits, typename Allocator = std::allocator<Value>>
 class radix_tree
 {
 public:
 	typedef Key key_t;
 	typedef Value value_t;
+	typedef Allocator allocator_type;
 
 	template<bool IsConst>
 	class base_iterator;
 
+	template<bool IsConst>
+	class base_covering_iterator;
+
+	template<bool IsConst>
+	class base_overlapping_iterator;
+
 	class node {
 	private:
 		friend class radix_tree;
@@ -24,23 +45,26 @@ public:
 		template<bool IsConst>
 		friend class base_iterator;
 
+		template<bool IsConst>
+		friend class base_covering_iterator;
+
+		template<bool IsConst>
+		friend class base_overlapping_iterator;
+
+		friend class frozen_radix_tree<Key, Value, KeyBitStringTraits>;
+
 		key_t m_key{};
-		std::unique_ptr<value_t> m_value;
-		std::unique_ptr<node> m_left;
-		std::unique_ptr<node> m_right;
+		// value and children are owned by the tree (see new_node() and delete_subtree())
+		value_t* m_value{nullptr};
+		node* m_left{nullptr};
+		node* m_right{nullptr};
 		node* m_parent{nullptr};
 
 		explicit node(key_t const& key, node* parent)
 		: m_key(key), m_parent(parent) {
 		}
 		node(node const& other) = delete;
-		node(node const& other, node* parent)
-		: m_key(other.m_key)
-		, m_value(other.m_value ? new Value(*other.m_value) : nullptr)
-		, m_left(other.m_left ? new node(*other.m_left, this) : nullptr)
-		, m_right(other.m_right ? new node(*other.m_right, this) : nullptr)
-		, m_parent(parent) {
-		}
+		node& operator=(node const& other) = delete;
 
 	public:
 		key_t const& key() const { return m_key; }
@@ -94,9 +118,9 @@ public:
 		void increment() {
 			for (;;) {
 				if (m_node->m_left) {
-					m_node = m_node->m_left.get();
+					m_node = m_node->m_left;
 				} else if (m_node->m_right) {
-					m_node = m_node->m_right.get();
+					m_node = m_node->m_right;
 				} else if (m_root == m_node) {
 					m_node = nullptr;
 					return; // reached end of tree
@@ -113,8 +137,8 @@ public:
 						assert(m_node);
 						// when we walk up and came through the left link, and the right link has a node,
 						// walk down the right link
-						if (m_node->m_left.get() == prev && m_node->m_right) {
-							m_node = m_node->m_right.get();
+						if (m_node->m_left == prev && m_node->m_right) {
+							m_node = m_node->m_right;
 							break;
 						}
 						// otherwise keep walking up
@@ -141,6 +165,106 @@ public:
 	typedef base_iterator<false> iterator;
 	typedef base_iterator<true> const_iterator;
 
+	// walks from a node up to the root, visiting only nodes with value
+	template<bool IsConst>
+	class base_covering_iterator : public boost::iterator_facade<base_covering_iterator<IsConst>, typename std::conditional<IsConst, node const, node>::type, boost::forward_traversal_tag> {
+	public:
+		base_covering_iterator() = default;
+
+		base_covering_iterator(base_covering_iterator const& other) = default;
+
+		// always allow copying from mutable constructor
+		template<bool IsConstArg, typename std::enable_if<!IsConstArg>::type* = nullptr>
+		base_covering_iterator(base_covering_iterator<IsConstArg> const& other)
+		: m_node(other.m_node) {
+		}
+
+	private:
+		friend class radix_tree;
+		friend class boost::iterator_core_access;
+		typedef typename std::conditional<IsConst, node const, node>::type Node;
+
+		node* m_node{nullptr};
+
+		// pos must be a node with value (or nullptr)
+		explicit base_covering_iterator(node* pos)
+		: m_node(pos) {
+			assert(!m_node || m_node->m_value);
+		}
+
+		void increment() {
+			do {
+				m_node = m_node->m_parent;
+			} while (m_node && !m_node->m_value);
+		}
+
+		template<bool IsConstArg>
+		bool equal(base_covering_iterator<IsConstArg> const& other) const
+		{
+			return m_node == other.m_node;
+		}
+
+		Node& dereference() const { return *m_node; }
+	};
+
+	typedef base_covering_iterator<false> covering_iterator;
+	typedef base_covering_iterator<true> const_covering_iterator;
+
+	// first walks up from a node to the root, then iterates (in order) from m_range_begin up to
+	// the end node; visits only nodes with value
+	template<bool IsConst>
+	class base_overlapping_iterator : public boost::iterator_facade<base_overlapping_iterator<IsConst>, typename std::conditional<IsConst, node const, node>::type, boost::forward_traversal_tag> {
+	public:
+		base_overlapping_iterator() = default;
+
+		base_overlapping_iterator(base_overlapping_iterator const& other) = default;
+
+		// always allow copying from mutable constructor
+		template<bool IsConstArg, typename std::enable_if<!IsConstArg>::type* = nullptr>
+		base_overlapping_iterator(base_overlapping_iterator<IsConstArg> const& other)
+		: m_node(other.m_node), m_range_begin(other.m_range_begin), m_in_chain(other.m_in_chain) {
+		}
+
+	private:
+		friend class radix_tree;
+		friend class boost::iterator_core_access;
+		typedef typename std::conditional<IsConst, node const, node>::type Node;
+
+		node* m_node{nullptr};
+		node* m_range_begin{nullptr};
+		bool m_in_chain{false};
+
+		// pos and range_begin must be nodes with value (or nullptr)
+		explicit base_overlapping_iterator(node* pos, node* range_begin, bool in_chain)
+		: m_node(pos), m_range_begin(range_begin), m_in_chain(in_chain) {
+			assert(!m_node || m_node->m_value);
+		}
+
+		void increment() {
+			if (m_in_chain) {
+				do {
+					m_node = m_node->m_parent;
+				} while (m_node && !m_node->m_value);
+				if (m_node) return;
+				m_in_chain = false;
+				m_node = m_range_begin;
+			} else {
+				m_node = next_value_node(m_node);
+			}
+		}
+
+		template<bool IsConstArg>
+		bool equal(base_overlapping_iterator<IsConstArg> const& other) const
+		{
+			return m_node == other.m_node;
+		}
+
+		Node& dereference() const { return *m_node; }
+	};
+
+	typedef base_overlapping_iterator<false> overlapping_iterator;
+	typedef base_overlapping_iterator<true> const_overlapping_iterator;
+
 private:
 	typedef typename KeyBitStringTraits::bitstring bitstring;
 	static bitstring key_to_bs(key_t const& key) {
@@ -152,18 +276,91 @@ private:
 		return keyBitStringTraits.bitstring_to_value(bs);
 	}
 
-	std::unique_ptr<node> m_root;
+	typedef typename std::allocator_traits<Allocator>::template rebind_alloc<node> node_allocator_type;
+	typedef typename std::allocator_traits<Allocator>::template rebind_alloc<value_t> value_allocator_type;
+	typedef std::allocator_traits<node_allocator_type> node_allocator_traits;
+	typedef std::allocator_traits<value_allocator_type> value_allocator_traits;
+	static_assert(std::is_same<typename node_allocator_traits::pointer, node*>::value, "radix_tree requires an allocator with raw pointers");
+	static_assert(std::is_same<typename value_allocator_traits::pointer, value_t*>::value, "radix_tree requires an allocator with raw pointers");
+
+	allocator_type m_allocator;
+	node* m_root{nullptr};
+
+	node* new_node(key_t const& key, node* parent) {
+		node_allocator_type allocator(m_allocator);
+		node* const n = node_allocator_traits::allocate(allocator, 1);
+		try {
+			// node constructor is private: can't use allocator construct()
+			::new (static_cast<void*>(n)) node(key, parent);
+		} catch (...) {
+			node_allocator_traits::deallocate(allocator, n, 1);
+			throw;
+		}
+		return n;
+	}
+
+	// doesn't free value or children
+	void delete_node(node* n) {
+		node_allocator_type allocator(m_allocator);
+		n->~node();
+		node_allocator_traits::deallocate(allocator, n, 1);
+	}
+
+	template<typename... Args>
+	value_t* new_value(Args&&... args) {
+		value_allocator_type allocator(m_allocator);
+		value_t* const v = value_allocator_traits::allocate(allocator, 1);
+		try {
+			value_allocator_traits::construct(allocator, v, std::forward<Args>(args)...);
+		} catch (...) {
+			value_allocator_traits::deallocate(allocator, v, 1);
+			throw;
+		}
+		return v;
+	}
+
+	void delete_value(node* n) {
+		if (!n->m_value) return;
+		value_allocator_type allocator(m_allocator);
+		value_allocator_traits::destroy(allocator, n->m_value);
+		value_allocator_traits::deallocate(allocator, n->m_value, 1);
+		n->m_value = nullptr;
+	}
+
+	// recursion depth is limited by the key length
+	void delete_subtree(node* n) {
+		if (!n) return;
+		delete_subtree(n->m_left);
+		delete_subtree(n->m_right);
+		delete_value(n);
+		delete_node(n);
+	}
+
+	node* copy_subtree(node const* other, node* parent) {
+		if (!other) return nullptr;
+		node* const n = new_node(other->m_key, parent);
+		try {
+			if (other->m_value) n->m_value = new_value(*other->m_value);
+			n->m_left = copy_subtree(other->m_left, n);
+			n->m_right = copy_subtree(other->m_right, n);
+		} catch (...) {
+			delete_subtree(n);
+			throw;
+		}
+		return n;
+	}
 
 	// find node which satisfies:
 	// - node key is prefixed by searched key
 	// - has the shortest key possible
 	// NOTE: doesn't necessarily have a value, don't return directly in iterator!
-	node* intern_lookup_parent(key_t const& key) const {
-		node* current = m_root.get();
-		bitstring const key_bs = key_to_bs(key);
+	node* intern_lookup_parent(bitstring const& key_bs) const {
+		PREFIX_TABLE_COUNT(radix_lookups, 1);
+		node* current = m_root;
 
 		for (;;) {
 			if (!current) return nullptr;
+			PREFIX_TABLE_COUNT(radix_lookup_nodes, 1);
 			bitstring const parent_key_bs = key_to_bs(current->m_key);
 			if (is_prefix(parent_key_bs, key_bs)) {
 				if (parent_key_bs == key_bs) {
@@ -172,9 +369,9 @@ private:
 				}
 				assert(key_bs.length() > parent_key_bs.length());
 				if (key_bs[parent_key_bs.length()]) {
-					current = current->m_right.get();
+					current = current->m_right;
 				} else {
-					current = current->m_left.get();
+					current = current->m_left;
 				}
 			} else if (is_prefix(key_bs, parent_key_bs)) {
 				// first node which has a key prefixed by key_bs
@@ -189,15 +386,16 @@ private:
 	// - node key is a prefix of searched key
 	// - has a value
 	// - has the longest key possible
-	node* intern_lookup(key_t const& key) const {
+	node* intern_lookup(bitstring const& key_bs) const {
+		PREFIX_TABLE_COUNT(radix_lookups, 1);
 		node* last_value_node = nullptr;
-		node* current = m_root.get();
-		bitstring const key_bs = key_to_bs(key);
+		node* current = m_root;
 
 		for (;;) {
 			if (!current) return last_value_node;
+			PREFIX_TABLE_COUNT(radix_lookup_nodes, 1);
 			bitstring const parent_key_bs = key_to_bs(current->m_key);
-			if (is_prefix(key_to_bs(current->m_key), key_bs)) {
+			if (is_prefix(parent_key_bs, key_bs)) {
 				if (current->m_value) last_value_node = current;
 				if (parent_key_bs == key_bs) {
 					// found an exact match
@@ -205,9 +403,9 @@ private:
 				}
 				assert(key_bs.length() > parent_key_bs.length());
 				if (key_bs[parent_key_bs.length()]) {
-					current = current->m_right.get();
+					current = current->m_right;
 				} else {
-					current = current->m_left.get();
+					current = current->m_left;
 				}
 			} else {
 				return last_value_node;
@@ -218,23 +416,24 @@ private:
 	// find node which satisfies:
 	// - has a key equal to searched key
 	// - has a value
-	node* intern_exact_lookup(key_t const& key) const {
-		node* current = m_root.get();
-		bitstring const key_bs = key_to_bs(key);
+	node* intern_exact_lookup(bitstring const& key_bs) const {
+		PREFIX_TABLE_COUNT(radix_lookups, 1);
+		node* current = m_root;
 
 		for (;;) {
 			if (!current) return nullptr;
+			PREFIX_TABLE_COUNT(radix_lookup_nodes, 1);
 			bitstring const parent_key_bs = key_to_bs(current->m_key);
-			if (is_prefix(key_to_bs(current->m_key), key_bs)) {
+			if (is_prefix(parent_key_bs, key_bs)) {
 				if (parent_key_bs == key_bs) {
 					// found an exact match; check whether it has a value
 					return current->m_value ? current : nullptr;
 				}
 				assert(key_bs.length() > parent_key_bs.length());
 				if (key_bs[parent_key_bs.length()]) {
-					current = current->m_right.get();
+					current = current->m_right;
 				} else {
-					current = current->m_left.get();
+					current = current->m_left;
 				}
 			} else {
 				return nullptr;
@@ -242,24 +441,104 @@ private:
 		}
 	}
 
+	// next node in iteration order after the complete subtree of n
+	static node* skip_subtree(node* n) {
+		for (node* parent = n->m_parent; parent; n = parent, parent = n->m_parent) {
+			if (parent->m_left == n && parent->m_right) return parent->m_right;
+		}
+		return nullptr;
+	}
+
+	// next node in iteration order (ignoring values)
+	static node* next_node(node* n) {
+		if (n->m_left) return n->m_left;
+		if (n->m_right) return n->m_right;
+		return skip_subtree(n);
+	}
+
+	// n or the next node with value in iteration order
+	static node* value_node_from(node* n) {
+		while (n && !n->m_value) n = next_node(n);
+		return n;
+	}
+
+	static node* next_value_node(node* n) {
+		return value_node_from(next_node(n));
+	}
+
+	// first node with value and a key lexicographically greater than or equal to (or, with
+	// upper == true, greater than) key_bs.
+	// iteration order is lexicographic order of the keys: a node comes before its subtrees,
+	// the left (0) subtree before the right (1) subtree.
+	node* intern_bound(bitstring const& key_bs, bool upper) const {
+		node* current = m_root;
+		while (current) {
+			bitstring const current_key_bs = key_to_bs(current->m_key);
+			if (is_prefix(current_key_bs, key_bs)) {
+				if (current_key_bs == key_bs) {
+					// all keys in the subtree are longer than key_bs
+					return value_node_from(upper ? next_node(current) : current);
+				}
+				// current is less than key_bs
+				assert(key_bs.length() > current_key_bs.length());
+				if (key_bs[current_key_bs.length()]) {
+					// whole left subtree is less than key_bs
+					if (!current->m_right) return value_node_from(skip_subtree(current));
+					current = current->m_right;
+				} else {
+					if (!current->m_left) {
+						// whole right subtree is greater than key_bs
+						return value_node_from(current->m_right ? current->m_right : skip_subtree(current));
+					}
+					current = current->m_left;
+				}
+			} else if (is_lexicographic_less(current_key_bs, key_bs)) {
+				// current and key_bs differ; whole subtree is less than key_bs
+				return value_node_from(skip_subtree(current));
+			} else {
+				// whole subtree is greater than key_bs
+				return value_node_from(current);
+			}
+		}
+		return nullptr;
+	}
+
+	// longest "real" prefix of key with value
+	node* intern_lookup_ancestor(bitstring const& key_bs) const {
+		node* n = intern_lookup(key_bs);
+		if (n && key_to_bs(n->m_key) == key_bs) {
+			do {
+				n = n->m_parent;
+			} while (n && !n->m_value);
+		}
+		return n;
+	}
+
 	node* intern_insert(key_t const& key) {
-		node* parent{nullptr};
-		std::unique_ptr<node>* insert_pos = &m_root;
-		bitstring const key_bs = key_to_bs(key);
+		return intern_insert(key, key_to_bs(key), &m_root, nullptr);
+	}
+
+	// same as intern_insert(key), but starts the search at the subtree of *insert_pos (with
+	// given parent); the key of parent (if any) must be a prefix of key
+	node* intern_insert(key_t const& key, bitstring const& key_bs, node** insert_pos, node* parent) {
+		PREFIX_TABLE_COUNT(radix_inserts, 1);
+		// doesn't bump the generation: new nodes have no value yet, lookups only change when
+		// the caller sets one
 
 		for (;;) {
 			if (!*insert_pos) {
-				insert_pos->reset(new node(key, parent));
-				return insert_pos->get();
+				*insert_pos = new_node(key, parent);
+				return *insert_pos;
 			}
+			PREFIX_TABLE_COUNT(radix_insert_nodes, 1);
 			bitstring const insert_pos_key_bs = key_to_bs((*insert_pos)->m_key);
 			if (is_prefix(insert_pos_key_bs, key_bs)) {
 				if (insert_pos_key_bs == key_bs) {
 					// found an exact match
-					return insert_pos->get();
+					return *insert_pos;
 				}
 				assert(key_bs.length() > insert_pos_key_bs.length());
-				parent = insert_pos->get();
+				parent = *insert_pos;
 				if (key_bs[insert_pos_key_bs.length()]) {
 					insert_pos = &(*insert_pos)->m_right;
 				} else {
@@ -273,55 +552,54 @@ private:
 				assert(common_prefix_bs.length() < insert_pos_key_bs.length());
 				if (common_prefix_bs.length() == key_bs.length()) {
 					// key_bs is a prefix of insert_pos_key_bs, insert between
-					std::unique_ptr<node> new_node{new node(key, parent)};
-					parent = new_node.get();
+					node* const n = new_node(key, parent);
 					if (insert_pos_key_bs[common_prefix_bs.length()]) {
-						new_node->m_right = std::move(*insert_pos);
-						new_node->m_right->m_parent = parent;
+						n->m_right = *insert_pos;
 					} else {
-						new_node->m_left = std::move(*insert_pos);
-						new_node->m_left->m_parent = parent;
+						n->m_left = *insert_pos;
 					}
-					*insert_pos = std::move(new_node);
-					return insert_pos->get();
+					(*insert_pos)->m_parent = n;
+					*insert_pos = n;
+					return n;
 				} else {
 					assert(common_prefix_bs.length() < key_bs.length());
 					// need a new node which forks to insert_pos_key_bs and key_bs; need to copy common_prefix into key
+					node* const n = new_node(key, nullptr);
+					node* fork;
+					try {
+						fork = new_node(bs_to_key(common_prefix_bs), parent);
+					} catch (...) {
+						delete_node(n);
+						throw;
+					}
+					n->m_parent = fork;
 					if (insert_pos_key_bs[common_prefix_bs.length()]) {
 						assert(!key_bs[common_prefix_bs.length()]);
-						std::unique_ptr<node> new_node{new node(bs_to_key(common_prefix_bs), parent)};
-						parent = new_node.get();
-						new_node->m_right = std::move(*insert_pos);
-						new_node->m_right->m_parent = parent;
-						new_node->m_left.reset(new node(key, parent));
-						*insert_pos = std::move(new_node);
-						return (*insert_pos)->m_left.get();
+						fork->m_right = *insert_pos;
+						fork->m_left = n;
 					} else {
 						assert(key_bs[common_prefix_bs.length()]);
-						std::unique_ptr<node> new_node{new node(bs_to_key(common_prefix_bs), parent)};
-						parent = new_node.get();
-						new_node->m_left = std::move(*insert_pos);
-						new_node->m_left->m_parent = parent;
-						new_node->m_right.reset(new node(key, parent));
-						*insert_pos = std::move(new_node);
-						return (*insert_pos)->m_right.get();
+						fork->m_left = *insert_pos;
+						fork->m_right = n;
 					}
+					(*insert_pos)->m_parent = fork;
+					*insert_pos = fork;
+					return n;
 				}
 			}
 		}
 	}
 
 	void merge(node* pos) {
-		// when copying a node pointer up make sure to create an intermediate pointer
-		// to keep the sub-object alive, as the assignment might kill it otherwise
+		PREFIX_TABLE_COUNT(radix_merge_nodes, 1);
 		if (!pos->m_value) {
-			std::unique_ptr<node> merge_up;
+			node* merge_up;
 			if (!pos->m_right) {
 				// delete "pos", replace with "pos->m_left":
-				std::unique_ptr<node> merge_up = std::move(pos->m_left);
+				merge_up = pos->m_left;
 			} else if (!pos->m_left) {
-				// delete "pos", replace with "pos->m_left":
-				std::unique_ptr<node> merge_up = std::move(pos->m_left);
+				// delete "pos", replace with "pos->m_right":
+				merge_up = pos->m_right;
 			} else {
 				// both forks still in use, not merging
 				return;
@@ -331,33 +609,147 @@ private:
 			if (merge_up) merge_up->m_parent = parent;
 
 			if (!parent) {
-				assert(pos == m_root.get());
-				m_root = std::move(merge_up);
+				assert(pos == m_root);
+				m_root = merge_up;
+				delete_node(pos);
 			} else {
-				if (parent->m_left.get() == pos) {
-					parent->m_left = std::move(merge_up);
+				if (parent->m_left == pos) {
+					parent->m_left = merge_up;
 				} else {
-					assert(parent->m_right.get() == pos);
-					parent->m_right = std::move(merge_up);
+					assert(parent->m_right == pos);
+					parent->m_right = merge_up;
 				}
+				delete_node(pos);
 				merge(parent);
 			}
 		}
 	}
 
+	// link to n in its parent (or the root link)
+	node** link_to(node* n) {
+		if (!n->m_parent) return &m_root;
+		return (n->m_parent->m_left == n) ? &n->m_parent->m_left : &n->m_parent->m_right;
+	}
+
+	// like intern_insert(key), but starts the search at the hint node (the entry after the
+	// position of key) instead of the root: walks up from the hint to the first node which is
+	// a prefix of key, the position of key is in its subtree (falls back to the root if there
+	// is none, or hint is nullptr for end())
+	node* intern_insert_hint(node* hint, key_t const& key) {
+		bitstring const key_bs = key_to_bs(key);
+		while (hint && !is_prefix(key_to_bs(hint->m_key), key_bs)) hint = hint->m_parent;
+		if (!hint) return intern_insert(key, key_bs, &m_root, nullptr);
+		return intern_insert(key, key_bs, link_to(hint), hint->m_parent);
+	}
+
+	// set value of a node from intern_insert() if it doesn't have one yet
+	template<typename... Args>
+	std::pair<iterator, bool> intern_emplace(node* n, Args&&... args) {
+		if (n->m_value) return std::make_pair(iterator(n, m_root), false);
+		m_generation.bump();
+		try {
+			n->m_value = new_value(std::forward<Args>(args)...);
+		} catch (...) {
+			// remove the node again if it was new
+			merge(n);
+			throw;
+		}
+		++m_size;
+		return std::make_pair(iterator(n, m_root), true);
+	}
+
 	void intern_remove(node* pos) {
+		PREFIX_TABLE_COUNT(radix_erases, 1);
+		m_generation.bump();
 		if (pos->m_value) --m_size;
-		pos->m_value.reset();
+		delete_value(pos);
 		merge(pos);
 	}
 
 	size_t intern_remove(key_t const& key) {
-		node* remove_pos = intern_exact_lookup(key);
+		node* remove_pos = intern_exact_lookup(key_to_bs(key));
 		if (!remove_pos) return 0;
 		intern_remove(remove_pos);
 		return 1;
 	}
 
+	// unlink the subtree with all keys prefixed by key_bs (or nullptr if there are none); merges
+	// the parent if needed. doesn't update size.
+	node* intern_detach(bitstring const& key_bs) {
+		node* const n = intern_lookup_parent(key_bs);
+		if (!n) return nullptr;
+		m_generation.bump();
+		node* const parent = n->m_parent;
+		n->m_parent = nullptr;
+		if (!parent) {
+			m_root = nullptr;
+		} else {
+			if (parent->m_left == n) {
+				parent->m_left = nullptr;
+			} else {
+				assert(parent->m_right == n);
+				parent->m_right = nullptr;
+			}
+			merge(parent);
+		}
+		return n;
+	}
+
+	// link a subtree (of nodes from a tree with an equal allocator) where its root key belongs;
+	// fails (returns false, nothing changed) if the tree already has a node with a key prefixed
+	// by the root key of the subtree
+	bool intern_graft(node* subtree) {
+		node* parent{nullptr};
+		node** insert_pos = &m_root;
+		bitstring const key_bs = key_to_bs(subtree->m_key);
+
+		for (;;) {
+			if (!*insert_pos) break;
+			bitstring const insert_pos_key_bs = key_to_bs((*insert_pos)->m_key);
+			if (is_prefix(key_bs, insert_pos_key_bs)) return false;
+			if (is_prefix(insert_pos_key_bs, key_bs)) {
+				parent = *insert_pos;
+				if (key_bs[insert_pos_key_bs.length()]) {
+					insert_pos = &(*insert_pos)->m_right;
+				} else {
+					insert_pos = &(*insert_pos)->m_left;
+				}
+			} else {
+				// need a new node which forks to insert_pos and the subtree
+				bitstring common_prefix_bs = longest_common_prefix(insert_pos_key_bs, key_bs);
+				node* const fork = new_node(bs_to_key(common_prefix_bs), parent);
+				if (key_bs[common_prefix_bs.length()]) {
+					fork->m_left = *insert_pos;
+					fork->m_right = subtree;
+				} else {
+					fork->m_left = subtree;
+					fork->m_right = *insert_pos;
+				}
+				(*insert_pos)->m_parent = fork;
+				subtree->m_parent = fork;
+				*insert_pos = fork;
+				m_generation.bump();
+				return true;
+			}
+		}
+		subtree->m_parent = parent;
+		*insert_pos = subtree;
+		m_generation.bump();
+		return true;
+	}
+
+	// number of nodes with value in a subtree
+	static size_t count_values(node const* n) {
+		if (!n) return 0;
+		return (n->m_value ? 1 : 0) + count_values(n->m_left) + count_values(n->m_right);
+	}
+
+	// bytes allocated for the nodes and values of a subtree
+	static size_t intern_memory_usage(node const* n) {
+		if (!n) return 0;
+		return sizeof(node) + (n->m_value ? sizeof(value_t) : 0) + intern_memory_usage(n->m_left) + intern_memory_usage(n->m_right);
+	}
+
 	boost::iterator_range<const_iterator> subtree(node* n) const {
 		return boost::make_iterator_range(const_iterator(n, n), const_iterator(nullptr, n));
 	}
@@ -396,83 +788,215 @@ private:
 	};
 
 	size_wrapper_type m_size;
+	table_generation m_generation;
 
 public:
 	radix_tree() = default;
+	explicit radix_tree(allocator_type const& allocator)
+	: m_allocator(allocator) {
+	}
 	radix_tree(radix_tree const& other)
-	: m_root(other.m_root ? new node(*other.m_root, nullptr) : nullptr) {
+	: m_allocator(std::allocator_traits<allocator_type>::select_on_container_copy_construction(other.m_allocator))
+	, m_root(copy_subtree(other.m_root, nullptr)), m_size(other.m_size), m_generation(other.m_generation) {
+	}
+	radix_tree(radix_tree&& other)
+	: m_allocator(other.m_allocator), m_root(other.m_root), m_size(std::move(other.m_size)), m_generation(std::move(other.m_generation)) {
+		other.m_root = nullptr;
 	}
-	radix_tree(radix_tree&& other) = default;
 	radix_tree& operator=(radix_tree const& other) {
-		if (this != &other) m_root.reset(other.m_root ? new node(*other.m_root, nullptr) : nullptr);
+		if (this != &other) {
+			node* const root = copy_subtree(other.m_root, nullptr);
+			delete_subtree(m_root);
+			m_root = root;
+			m_size = other.m_size;
+			m_generation = other.m_generation;
+		}
 		return *this;
 	}
-	radix_tree& operator=(radix_tree&& other) = default;
+	radix_tree& operator=(radix_tree&& other) {
+		if (this != &other) {
+			node* root;
+			if (m_allocator == other.m_allocator) {
+				root = other.m_root;
+			} else {
+				// can't free nodes from other allocator
+				root = copy_subtree(other.m_root, nullptr);
+				other.delete_subtree(other.m_root);
+			}
+			other.m_root = nullptr;
+			delete_subtree(m_root);
+			m_root = root;
+			m_size = std::move(other.m_size);
+			m_generation = std::move(other.m_generation);
+		}
+		return *this;
+	}
+	~radix_tree() {
+		delete_subtree(m_root);
+	}
+
+	allocator_type get_allocator() const {
+		return m_allocator;
+	}
 
 	template<typename ValueArg>
 	std::pair<iterator, bool> insert(key_t const& key, ValueArg&& value) {
-		node* n = intern_insert(key);
-		if (n->m_value) return std::make_pair(iterator(n, m_root.get()), false);
-		n->m_value.reset(new value_t(std::forward<ValueArg>(value)));
-		++m_size;
-		return std::make_pair(iterator(n, m_root.get()), true);
+		return intern_emplace(intern_insert(key), std::forward<ValueArg>(value));
+	}
+
+	// insert with value constructed from args, but only if key isn't present yet (then nothing
+	// is constructed, and the args aren't touched)
+	template<typename... Args>
+	std::pair<iterator, bool> try_emplace(key_t const& key, Args&&... args) {
+		return intern_emplace(intern_insert(key), std::forward<Args>(args)...);
+	}
+
+	// try_emplace() with a hint: the position just after where key goes, i.e. the first entry
+	// with a key greater than key or end() (like std::map::emplace_hint; end() when inserting
+	// keys in order). a good hint saves the search, a wrong one only costs that saving.
+	// returns the entry with key (the new or the already present one)
+	template<typename... Args>
+	iterator emplace_hint(const_iterator hint, key_t const& key, Args&&... args) {
+		return intern_emplace(intern_insert_hint(hint.m_node, key), std::forward<Args>(args)...).first;
 	}
 
 	template<typename ValueArg>
 	std::pair<iterator, bool> insert_or_assign(key_t const& key, ValueArg&& value) {
 		node* n = intern_insert(key);
+		m_generation.bump();
 		if (n->m_value) {
 			*n->m_value = std::forward<ValueArg>(value);
-			return std::make_pair(iterator(n, m_root.get()), false);
+			return std::make_pair(iterator(n, m_root), false);
 		} else {
-			n->m_value.reset(new value_t(std::forward<ValueArg>(value)));
+			n->m_value = new_value(std::forward<ValueArg>(value));
 			++m_size;
-			return std::make_pair(iterator(n, m_root.get()), true);
+			return std::make_pair(iterator(n, m_root), true);
 		}
 	}
 
+	// insert all (key, value) pairs from the given range, but don't overwrite existing entries
+	template<typename InputIterator>
+	void insert(InputIterator first, InputIterator last) {
+		for (; first != last; ++first) insert(first->first, first->second);
+	}
+
+	// insert, or assign if key is already present, all (key, value) pairs from the given range
+	template<typename InputIterator>
+	void insert_or_assign(InputIterator first, InputIterator last) {
+		for (; first != last; ++first) insert_or_assign(first->first, first->second);
+	}
+
 	const_iterator find(key_t const& key) const {
-		return const_iterator(intern_lookup(key), m_root.get());
+		return const_iterator(intern_lookup(key_to_bs(key)), m_root);
 	}
 
 	iterator find(key_t const& key) {
-		return iterator(intern_lookup(key), m_root.get());
+		return iterator(intern_lookup(key_to_bs(key)), m_root);
 	}
 
 	const_iterator find_exact(key_t const& key) const {
-		return const_iterator(intern_exact_lookup(key), m_root.get());
+		return const_iterator(intern_exact_lookup(key_to_bs(key)), m_root);
 	}
 
 	iterator find_exact(key_t const& key) {
-		return iterator(intern_exact_lookup(key), m_root.get());
+		return iterator(intern_exact_lookup(key_to_bs(key)), m_root);
 	}
 
 	boost::iterator_range<const_iterator> find_all(key_t const& key) const {
-		return subtree(intern_lookup_parent(key));
+		return subtree(intern_lookup_parent(key_to_bs(key)));
 	}
 
 	boost::iterator_range<iterator> find_all(key_t const& key) {
-		return subtree(intern_lookup_parent(key));
+		return subtree(intern_lookup_parent(key_to_bs(key)));
+	}
+
+	// all entries with a key that is a prefix of the given key, from the longest to the shortest key.
+	// the first entry is the one find() returns.
+	boost::iterator_range<const_covering_iterator> covering(key_t const& key) const {
+		return boost::make_iterator_range(const_covering_iterator(intern_lookup(key_to_bs(key))), const_covering_iterator());
+	}
+
+	boost::iterator_range<covering_iterator> covering(key_t const& key) {
+		return boost::make_iterator_range(covering_iterator(intern_lookup(key_to_bs(key))), covering_iterator());
+	}
+
+	// all entries intersecting the address interval [lo, hi]: the entries with a key that is a
+	// "real" prefix of lo (from the longest to the shortest key), followed by all entries with a
+	// key between lo and hi (in lexicographic order).
+	// lo and hi are compared as bitstrings; use full length keys for an address interval.
+	boost::iterator_range<const_overlapping_iterator> overlapping(key_t const& lo, key_t const& hi) const {
+		bitstring const lo_bs = key_to_bs(lo);
+		bitstring const hi_bs = key_to_bs(hi);
+		if (is_lexicographic_less(hi_bs, lo_bs)) {
+			return boost::make_iterator_range(const_overlapping_iterator(), const_overlapping_iterator());
+		}
+		node* const range_begin = intern_bound(lo_bs, false);
+		node* const range_end = intern_bound(hi_bs, true);
+		node* const chain = intern_lookup_ancestor(lo_bs);
+		return boost::make_iterator_range(
+			chain ? const_overlapping_iterator(chain, range_begin, true) : const_overlapping_iterator(range_begin, range_begin, false),
+			const_overlapping_iterator(range_end, range_begin, false));
+	}
+
+	boost::iterator_range<overlapping_iterator> overlapping(key_t const& lo, key_t const& hi) {
+		auto const range = static_cast<radix_tree const&>(*this).overlapping(lo, hi);
+		return boost::make_iterator_range(
+			overlapping_iterator(range.begin().m_node, range.begin().m_range_begin, range.begin().m_in_chain),
+			overlapping_iterator(range.end().m_node, range.end().m_range_begin, range.end().m_in_chain));
 	}
 
 	const value_t* value(key_t const& key) const {
-		node *n = intern_lookup(key);
-		return n ? n->m_value.get() : nullptr;
+		node *n = intern_lookup(key_to_bs(key));
+		return n ? n->m_value : nullptr;
 	}
 
 	value_t* value(key_t const& key) {
-		node *n = intern_lookup(key);
-		return n ? n->m_value.get() : nullptr;
+		node *n = intern_lookup(key_to_bs(key));
+		return n ? n->m_value : nullptr;
+	}
+
+	// find(), find_exact() and value() by address (see KeyBitStringTraits::address_to_bitstring
+	// in bitstring.hpp) or by bitstring; no key object is constructed
+	template<typename Address, typename = decltype(traits_address_to_bitstring<KeyBitStringTraits>(std::declval<Address const&>()))>
+	const_iterator find(Address const& address) const {
+		return const_iterator(intern_lookup(traits_address_to_bitstring<KeyBitStringTraits>(address)), m_root);
+	}
+
+	template<typename Address, typename = decltype(traits_address_to_bitstring<KeyBitStringTraits>(std::declval<Address const&>()))>
+	iterator find(Address const& address) {
+		return iterator(intern_lookup(traits_address_to_bitstring<KeyBitStringTraits>(address)), m_root);
+	}
+
+	template<typename Address, typename = decltype(traits_address_to_bitstring<KeyBitStringTraits>(std::declval<Address const&>()))>
+	const_iterator find_exact(Address const& address) const {
+		return const_iterator(intern_exact_lookup(traits_address_to_bitstring<KeyBitStringTraits>(address)), m_root);
+	}
+
+	template<typename Address, typename = decltype(traits_address_to_bitstring<KeyBitStringTraits>(std::declval<Address const&>()))>
+	iterator find_exact(Address const& address) {
+		return iterator(intern_exact_lookup(traits_address_to_bitstring<KeyBitStringTraits>(address)), m_root);
+	}
+
+	template<typename Address, typename = decltype(traits_address_to_bitstring<KeyBitStringTraits>(std::declval<Address const&>()))>
+	const value_t* value(Address const& address) const {
+		node *n = intern_lookup(traits_address_to_bitstring<KeyBitStringTraits>(address));
+		return n ? n->m_value : nullptr;
+	}
+
+	template<typename Address, typename = decltype(traits_address_to_bitstring<KeyBitStringTraits>(std::declval<Address const&>()))>
+	value_t* value(Address const& address) {
+		node *n = intern_lookup(traits_address_to_bitstring<KeyBitStringTraits>(address));
+		return n ? n->m_value : nullptr;
 	}
 
 	const value_t* value_exact(key_t const& key) const {
-		node *n = intern_exact_lookup(key);
-		return n ? n->m_value.get() : nullptr;
+		node *n = intern_exact_lookup(key_to_bs(key));
+		return n ? n->m_value : nullptr;
 	}
 
 	value_t* value_exact(key_t const& key) {
-		node *n = intern_exact_lookup(key);
-		return n ? n->m_value.get() : nullptr;
+		node *n = intern_exact_lookup(key_to_bs(key));
+		return n ? n->m_value : nullptr;
 	}
 
 	size_t erase(key_t const& key) {
@@ -484,7 +1008,7 @@ public:
 		iterator next(pos.m_node, pos.m_root, typename iterator::no_init_walk{});
 
 		// remember next child in iteration order
-		node* next_child = pos.m_node->m_left ? pos.m_node->m_left.get() : pos.m_node->m_right.get();
+		node* next_child = pos.m_node->m_left ? pos.m_node->m_left : pos.m_node->m_right;
 		++next;
 		// "next.m_node" doesn't have to be next_child if next_child didn't have a value!
 
@@ -503,8 +1027,50 @@ public:
 		return next;
 	}
 
+	// erase all elements with a key prefixed by the given key (i.e. the key itself and all
+	// more specific keys); unlinks the subtree and frees it in one walk. returns how many
+	// elements were deleted
+	size_t erase_subtree(key_t const& key) {
+		node* const n = intern_detach(key_to_bs(key));
+		size_t const count = count_values(n);
+		m_size.m_value -= count;
+		delete_subtree(n);
+		return count;
+	}
+
+	// move all elements with a key prefixed by the given key into a new tree (with the same
+	// allocator); no node or value is copied
+	radix_tree extract_subtree(key_t const& key) {
+		radix_tree result(m_allocator);
+		node* const n = intern_detach(key_to_bs(key));
+		result.m_root = n;
+		result.m_size.m_value = count_values(n);
+		m_size.m_value -= result.m_size.m_value;
+		return result;
+	}
+
+	// move all elements from other into this tree; elements with a key already present stay in
+	// other (like std::map::merge). if the allocators are equal and this tree has no key prefixed
+	// by the shortest key in other (e.g. other came from extract_subtree()), other is linked in
+	// as a whole; otherwise the elements are moved one by one.
+	void splice(radix_tree& other) {
+		if (this == &other || !other.m_root) return;
+		if (m_allocator == other.m_allocator && intern_graft(other.m_root)) {
+			m_size.m_value += other.m_size.m_value;
+			other.m_root = nullptr;
+			other.m_size.m_value = 0;
+			other.m_generation.bump();
+			return;
+		}
+		std::vector<key_t> moved;
+		for (auto& elem: other) {
+			if (insert(elem.key(), std::move(elem.value())).second) moved.push_back(elem.key());
+		}
+		for (auto const& key: moved) other.erase(key);
+	}
+
 	void clear() {
-		*this = radix_tree();
+		*this = radix_tree(m_allocator);
 	}
 
 	bool empty() const {
@@ -515,17 +1081,34 @@ public:
 		return m_size.m_value;
 	}
 
-	iterator begin() { return iterator(m_root.get(), m_root.get()); }
-	iterator end() { return iterator(nullptr, m_root.get()); }
-	const_iterator begin() const { return const_iterator(m_root.get(), m_root.get()); }
-	const_iterator end() const { return const_iterator(nullptr, m_root.get()); }
-	const_iterator cbegin() const { return const_iterator(m_root.get(), m_root.get()); }
-	const_iterator cend() const { return const_iterator(nullptr, m_root.get()); }
+	// bytes allocated for the table itself (not counting memory owned by keys or values)
+	size_t memory_usage() const {
+		return sizeof(*this) + intern_memory_usage(m_root);
+	}
+
+	// changes on every modification of the table (see table_generation)
+	uint64_t generation() const {
+		return m_generation.value();
+	}
+
+	// create an immutable copy optimized for lookups
+	frozen_radix_tree<Key, Value, KeyBitStringTraits> freeze() const {
+		return frozen_radix_tree<Key, Value, KeyBitStringTraits>(m_root);
+	}
+
+	iterator begin() { return iterator(m_root, m_root); }
+	iterator end() { return iterator(nullptr, m_root); }
+	const_iterator begin() const { return const_iterator(m_root, m_root); }
+	const_iterator end() const { return const_iterator(nullptr, m_root); }
+	const_iterator cbegin() const { return const_iterator(m_root, m_root); }
+	const_iterator cend() const { return const_iterator(nullptr, m_root); }
 
 	/** swap content of two trees */
 	friend void swap(radix_tree& a, radix_tree& b) {
 		using std::swap;
+		assert(a.m_allocator == b.m_allocator);
 		swap(a.m_size, b.m_size);
 		swap(a.m_root, b.m_root);
+		swap(a.m_generation, b.m_generation);
 	}
 };
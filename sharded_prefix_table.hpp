@@ -0,0 +1,265 @@
+#pragma once
+
+#include "bitstring.hpp"
+#include "prefix_vector.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <utility>
+#include <vector>
+
+#include <stddef.h>
+
+// thread-safe table partitioned by the first `ShardBits` bits of the key (e.g. 256 shards for
+// the IPv4 /8s); each shard is a separate `Table` (any prefix_vector or radix_tree
+// instantiation) with its own readers/writer lock, so updates in different shards run in
+// parallel, and the O(n) fix-up of a prefix_vector insert or erase only touches one shard.
+// keys shorter than `ShardBits` are replicated into all shards they cover (all 2^ShardBits
+// for the default route), so a lookup only reads (and locks) a single shard. updates of such
+// keys are serialized and lock their shards one after the other (a concurrent lookup can
+// still see the old entry in the shards which aren't updated yet).
+//
+// lookups copy the value under the lock; there is no iterator or pointer based access.
+template<
+	typename Key,
+	typename Value,
+	typename KeyBitStringTraits,
+	unsigned int ShardBits = 8,
+	typename Table = prefix_vector<Key, Value, KeyBitStringTraits>>
+class sharded_prefix_table {
+public:
+	typedef Key key_t;
+	typedef Value value_t;
+	typedef Table table_t;
+
+	static constexpr size_t SHARD_COUNT{size_t{1} << ShardBits};
+
+private:
+	typedef typename KeyBitStringTraits::bitstring bitstring;
+	typedef std::shared_timed_mutex mutex_t;
+	typedef std::shared_lock<mutex_t> read_lock;
+	typedef std::unique_lock<mutex_t> write_lock;
+
+	struct shard {
+		mutable mutex_t m_mutex;
+		table_t m_table;
+		// entries in m_table which are copies of a shorter key from its first shard
+		size_t m_replicas{0};
+	};
+
+	typedef std::pair<size_t, size_t> shard_range_t;
+
+	std::unique_ptr<shard[]> m_shards{new shard[SHARD_COUNT]};
+	// serializes the updates of keys shorter than ShardBits
+	std::mutex m_replicated_mutex;
+
+	static bitstring key_to_bs(key_t const& key) {
+		KeyBitStringTraits keyBitStringTraits{};
+		return keyBitStringTraits.value_to_bitstring(key);
+	}
+
+	// [first, last) shards covered by a key: a single one for keys with at least ShardBits
+	// bits, otherwise all shards starting with the bits of the key
+	static shard_range_t shard_range(bitstring const& bs) {
+		size_t const bits = std::min<size_t>(bs.length(), ShardBits);
+		size_t first = 0;
+		for (size_t i = 0; i < bits; ++i) first = (first << 1) | (bs[i] ? 1u : 0u);
+		first <<= ShardBits - bits;
+		return shard_range_t(first, first + (size_t{1} << (ShardBits - bits)));
+	}
+
+	// shard to look up a key in (the first shard of its range)
+	static size_t shard_index(bitstring const& bs) {
+		return shard_range(bs).first;
+	}
+
+	shard& shard_for(key_t const& key) const {
+		return m_shards[shard_index(key_to_bs(key))];
+	}
+
+	template<typename LookupKey>
+	bool intern_value(size_t ndx, LookupKey const& key, value_t& result) const {
+		shard const& s = m_shards[ndx];
+		read_lock lock(s.m_mutex);
+		value_t const* const v = s.m_table.value(key);
+		if (!v) return false;
+		result = *v;
+		return true;
+	}
+
+	// insert a key shorter than ShardBits into all shards of its range, one shard after the
+	// other. if an exception is thrown a new key is removed again, but an assignment can be
+	// left done in some shards
+	bool insert_replicated(key_t const& key, value_t const& value, shard_range_t range, bool assign) {
+		std::lock_guard<std::mutex> guard(m_replicated_mutex);
+		bool exists;
+		{
+			shard const& s = m_shards[range.first];
+			read_lock lock(s.m_mutex);
+			exists = (s.m_table.find_exact(key) != s.m_table.end());
+		}
+		if (exists) {
+			if (!assign) return false;
+			for (size_t i = range.first; i < range.second; ++i) {
+				write_lock lock(m_shards[i].m_mutex);
+				m_shards[i].m_table.insert_or_assign(key, value);
+			}
+			return false;
+		}
+		size_t i = range.first;
+		try {
+			for (; i < range.second; ++i) {
+				write_lock lock(m_shards[i].m_mutex);
+				m_shards[i].m_table.insert(key, value);
+				if (i != range.first) ++m_shards[i].m_replicas;
+			}
+		} catch (...) {
+			while (i-- > range.first) {
+				write_lock lock(m_shards[i].m_mutex);
+				m_shards[i].m_table.erase(key);
+				if (i != range.first) --m_shards[i].m_replicas;
+			}
+			throw;
+		}
+		return true;
+	}
+
+	size_t erase_replicated(key_t const& key, shard_range_t range) {
+		std::lock_guard<std::mutex> guard(m_replicated_mutex);
+		{
+			write_lock lock(m_shards[range.first].m_mutex);
+			if (0 == m_shards[range.first].m_table.erase(key)) return 0;
+		}
+		for (size_t i = range.first + 1; i < range.second; ++i) {
+			write_lock lock(m_shards[i].m_mutex);
+			m_shards[i].m_table.erase(key);
+			--m_shards[i].m_replicas;
+		}
+		return 1;
+	}
+
+public:
+	sharded_prefix_table() = default;
+	sharded_prefix_table(sharded_prefix_table const& other) = delete;
+	sharded_prefix_table& operator=(sharded_prefix_table const& other) = delete;
+
+	// copy value from entry with longest matching prefix of key into result; returns false
+	// (and leaves result alone) if there is no match
+	bool value(key_t const& key, value_t& result) const {
+		return intern_value(shard_index(key_to_bs(key)), key, result);
+	}
+
+	// same by address (see KeyBitStringTraits::address_to_bitstring in bitstring.hpp)
+	template<typename Address, typename = decltype(traits_address_to_bitstring<KeyBitStringTraits>(std::declval<Address const&>()))>
+	bool value(Address const& address, value_t& result) const {
+		return intern_value(shard_index(traits_address_to_bitstring<KeyBitStringTraits>(address)), address, result);
+	}
+
+	// copy value from entry with key equal to given key
+	bool value_exact(key_t const& key, value_t& result) const {
+		shard const& s = shard_for(key);
+		read_lock lock(s.m_mutex);
+		auto const it = s.m_table.find_exact(key);
+		if (it == s.m_table.end()) return false;
+		result = it->value();
+		return true;
+	}
+
+	// insert, but don't overwrite existing entry (returns false if key is already present)
+	template<typename ValueArg>
+	bool insert(key_t const& key, ValueArg&& value) {
+		shard_range_t const range = shard_range(key_to_bs(key));
+		if (range.second - range.first > 1) return insert_replicated(key, value, range, false);
+		shard& s = m_shards[range.first];
+		write_lock lock(s.m_mutex);
+		return s.m_table.insert(key, std::forward<ValueArg>(value)).second;
+	}
+
+	// insert, or assign if key is already present
+	template<typename ValueArg>
+	void insert_or_assign(key_t const& key, ValueArg&& value) {
+		shard_range_t const range = shard_range(key_to_bs(key));
+		if (range.second - range.first > 1) {
+			insert_replicated(key, value, range, true);
+			return;
+		}
+		shard& s = m_shards[range.first];
+		write_lock lock(s.m_mutex);
+		s.m_table.insert_or_assign(key, std::forward<ValueArg>(value));
+	}
+
+	// insert, or assign if key is already present, all (key, value) pairs from the given range;
+	// the pairs are grouped by shard and each shard gets a single batch insert (keys shorter
+	// than ShardBits are inserted one by one)
+	template<typename InputIterator>
+	void insert_or_assign(InputIterator first, InputIterator last) {
+		std::vector<std::vector<std::pair<key_t, value_t>>> batches(SHARD_COUNT);
+		for (; first != last; ++first) {
+			shard_range_t const range = shard_range(key_to_bs(first->first));
+			if (range.second - range.first > 1) {
+				insert_replicated(first->first, first->second, range, true);
+			} else {
+				batches[range.first].emplace_back(first->first, first->second);
+			}
+		}
+		for (size_t i = 0; i < SHARD_COUNT; ++i) {
+			if (batches[i].empty()) continue;
+			write_lock lock(m_shards[i].m_mutex);
+			m_shards[i].m_table.insert_or_assign(batches[i].begin(), batches[i].end());
+		}
+	}
+
+	// erase element with given key. returns how many elements were deleted (0 or 1)
+	size_t erase(key_t const& key) {
+		shard_range_t const range = shard_range(key_to_bs(key));
+		if (range.second - range.first > 1) return erase_replicated(key, range);
+		shard& s = m_shards[range.first];
+		write_lock lock(s.m_mutex);
+		return s.m_table.erase(key);
+	}
+
+	// calls `f(key, value)` for all entries, shard by shard (each shard is locked while its
+	// entries are visited); keys shorter than ShardBits are visited in the first shard they
+	// cover. `f` must not access the table.
+	template<typename Function>
+	void for_each(Function&& f) const {
+		for (size_t i = 0; i < SHARD_COUNT; ++i) {
+			shard const& s = m_shards[i];
+			read_lock lock(s.m_mutex);
+			for (auto const& elem: s.m_table) {
+				if (0 == s.m_replicas || shard_index(key_to_bs(elem.key())) == i) f(elem.key(), elem.value());
+			}
+		}
+	}
+
+	// the following only are consistent if there are no concurrent updates
+
+	bool empty() const {
+		return 0 == size();
+	}
+
+	size_t size() const {
+		size_t result = 0;
+		for (size_t i = 0; i < SHARD_COUNT; ++i) {
+			read_lock lock(m_shards[i].m_mutex);
+			result += m_shards[i].m_table.size() - m_shards[i].m_replicas;
+		}
+		return result;
+	}
+
+	// bytes allocated for the table itself, including the replicas of short keys (not
+	// counting memory owned by keys or values)
+	size_t memory_usage() const {
+		size_t result = sizeof(*this) + SHARD_COUNT * (sizeof(shard) - sizeof(table_t));
+		for (size_t i = 0; i < SHARD_COUNT; ++i) {
+			read_lock lock(m_shards[i].m_mutex);
+			result += m_shards[i].m_table.memory_usage();
+		}
+		return result;
+	}
+};
+
+template<typename Key, typename Value, typename KeyBitStringTraits, unsigned int ShardBits, typename Table>
+constexpr size_t sharded_prefix_table<Key, Value, KeyBitStringTraits, ShardBits, Table>::SHARD_COUNT;
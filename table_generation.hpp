@@ -0,0 +1,50 @@
+#pragma once
+
+#include <algorithm>
+
+#include <stdint.h>
+
+// modification counter of a table: changes whenever the content of the table changes (insert,
+// erase, assignment, swap), so caches can tag their entries with it and never need to be
+// invalidated explicitly.
+// after assignment and swap both tables get a generation neither of them had before.
+class table_generation {
+private:
+	uint64_t m_value{0};
+
+	void advance_past(table_generation const& other) {
+		m_value = std::max(m_value, other.m_value) + 1;
+	}
+
+public:
+	table_generation() = default;
+	table_generation(table_generation const& other) = default;
+	table_generation(table_generation&& other)
+	: m_value(other.m_value) {
+		other.bump();
+	}
+
+	table_generation& operator=(table_generation const& other) {
+		advance_past(other);
+		return *this;
+	}
+
+	table_generation& operator=(table_generation&& other) {
+		advance_past(other);
+		other.m_value = m_value;
+		return *this;
+	}
+
+	void bump() {
+		++m_value;
+	}
+
+	uint64_t value() const {
+		return m_value;
+	}
+
+	friend void swap(table_generation& a, table_generation& b) {
+		a.advance_past(b);
+		b.m_value = a.m_value;
+	}
+};
@@ -0,0 +1,158 @@
+#pragma once
+
+#include "ipv4_network.hpp"
+#include "ipv6_network.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+// synthetic routing tables for benchmarks, following the prefix length distribution of the
+// public BGP tables: most IPv4 prefixes are /24 (IPv6: /48), with a long tail of shorter ones.
+// a part of the longer prefixes are more-specifics of other prefixes in the table.
+class table_generator {
+private:
+	std::mt19937_64 m_rng;
+
+	// per mille of prefixes with the given length
+	static unsigned int ipv4_length_weight(unsigned int length) {
+		static unsigned int const weights[33] = {
+			0, 0, 0, 0, 0, 0, 0, 0,
+			1, 1, 1, 1, 1, 1, 1, 2, // /8 - /15
+			13, 8, 14, 25, 42, 48, 110, 85, // /16 - /23
+			641, // /24
+		};
+		return weights[length];
+	}
+
+	static unsigned int ipv6_length_weight(unsigned int length) {
+		switch (length) {
+		case 20: return 1;
+		case 29: return 30;
+		case 32: return 120;
+		case 33: case 34: case 35: return 5;
+		case 36: return 25;
+		case 40: return 60;
+		case 42: return 10;
+		case 44: return 80;
+		case 45: return 15;
+		case 46: case 47: return 25;
+		case 48: return 584;
+		default: return 0;
+		}
+	}
+
+	template<typename WeightFunction>
+	std::discrete_distribution<unsigned int> length_distribution(unsigned int max_length, WeightFunction weight) {
+		std::vector<double> weights;
+		for (unsigned int length = 0; length <= max_length; ++length) weights.push_back(weight(length));
+		return std::discrete_distribution<unsigned int>(weights.begin(), weights.end());
+	}
+
+	// percentage of prefixes generated as more-specific of an existing prefix
+	static constexpr unsigned int MORE_SPECIFIC_PERCENT{30};
+
+public:
+	explicit table_generator(uint64_t seed = 1)
+	: m_rng(seed) {
+	}
+
+	std::mt19937_64& rng() { return m_rng; }
+
+	// `count` distinct prefixes in random order
+	std::vector<ipv4_network> ipv4_table(size_t count) {
+		auto lengths = length_distribution(32, ipv4_length_weight);
+		std::unordered_set<uint64_t> seen;
+		std::vector<ipv4_network> result;
+		result.reserve(count);
+		while (result.size() < count) {
+			unsigned char const length = static_cast<unsigned char>(lengths(m_rng));
+			// unicast space 1.0.0.0 - 223.255.255.255
+			uint32_t native_address = static_cast<uint32_t>(m_rng());
+			native_address = (native_address % (0xe0000000u - 0x01000000u)) + 0x01000000u;
+			if (!result.empty() && m_rng() % 100 < MORE_SPECIFIC_PERCENT) {
+				ipv4_network const& parent = result[m_rng() % result.size()];
+				if (parent.network() < length) {
+					native_address = parent.native_address() | (native_address & ntohl(ipv4_network::hostmask(parent.network())));
+				}
+			}
+			ipv4_network const network(htonl(native_address), length);
+			if (seen.insert((uint64_t{network.native_address()} << 8) | network.network()).second) result.push_back(network);
+		}
+		return result;
+	}
+
+	std::vector<ipv6_network> ipv6_table(size_t count) {
+		auto lengths = length_distribution(128, ipv6_length_weight);
+		std::unordered_set<uint64_t> seen;
+		std::vector<ipv6_network> result;
+		result.reserve(count);
+		while (result.size() < count) {
+			unsigned char const length = static_cast<unsigned char>(lengths(m_rng));
+			// global unicast 2000::/3; all generated lengths are <= 48, so the low word stays 0
+			uint64_t high = (m_rng() >> 3) | (uint64_t{1} << 61);
+			if (!result.empty() && m_rng() % 100 < MORE_SPECIFIC_PERCENT) {
+				ipv6_network const& parent = result[m_rng() % result.size()];
+				if (parent.network() < length) {
+					high = parent.high() | (high & ~ipv6_network::netmask_high(parent.network()));
+				}
+			}
+			ipv6_network const network(high, 0, length);
+			// the lowest byte of high is always 0 (length <= 48), use it for the length
+			if (seen.insert(network.high() | network.network()).second) result.push_back(network);
+		}
+		return result;
+	}
+
+	// `count` host addresses from random prefixes of the table (so lookups usually find a match)
+	std::vector<ipv4_network> ipv4_addresses(std::vector<ipv4_network> const& table, size_t count) {
+		std::vector<ipv4_network> result;
+		result.reserve(count);
+		for (size_t i = 0; i < count; ++i) result.push_back(host_in(table[m_rng() % table.size()]));
+		return result;
+	}
+
+	std::vector<ipv6_network> ipv6_addresses(std::vector<ipv6_network> const& table, size_t count) {
+		std::vector<ipv6_network> result;
+		result.reserve(count);
+		for (size_t i = 0; i < count; ++i) result.push_back(host_in(table[m_rng() % table.size()]));
+		return result;
+	}
+
+	// like ipv4_addresses/ipv6_addresses, but the prefixes are chosen with a Zipf distribution
+	template<typename Network>
+	std::vector<Network> zipf_addresses(std::vector<Network> const& table, size_t count, double exponent = 1.0) {
+		// popularity rank of table[i] is i; the table itself is in random order
+		std::vector<double> cdf(table.size());
+		double sum = 0;
+		for (size_t i = 0; i < table.size(); ++i) {
+			sum += 1.0 / std::pow(static_cast<double>(i + 1), exponent);
+			cdf[i] = sum;
+		}
+		std::uniform_real_distribution<double> uniform(0, sum);
+
+		std::vector<Network> result;
+		result.reserve(count);
+		for (size_t i = 0; i < count; ++i) {
+			size_t const ndx = static_cast<size_t>(std::lower_bound(cdf.begin(), cdf.end(), uniform(m_rng)) - cdf.begin());
+			result.push_back(host_in(table[std::min(ndx, table.size() - 1)]));
+		}
+		return result;
+	}
+
+	// random full-length address in network
+	ipv4_network host_in(ipv4_network network) {
+		return ipv4_network(network.address() | (static_cast<uint32_t>(m_rng()) & ipv4_network::hostmask(network.network())));
+	}
+
+	ipv6_network host_in(ipv6_network network) {
+		return ipv6_network(
+			network.high() | (m_rng() & ~ipv6_network::netmask_high(network.network())),
+			network.low() | (m_rng() & ~ipv6_network::netmask_low(network.network())));
+	}
+};
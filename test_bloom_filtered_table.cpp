@@ -0,0 +1,92 @@
+#include "bloom_filtered_table.hpp"
+#include "ipv4_network.hpp"
+#include "ipv6_network.hpp"
+#include "radix_tree.hpp"
+
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <netinet/ip.h>
+#include <stddef.h>
+#include <stdint.h>
+
+void run_ipv4_network() {
+	bloom_filtered_table<ipv4_network, std::string, ipv4_network_bitstring_traits> routing_table;
+	ipv4_network any{0, 0};
+	ipv4_network private_net{ htonl(0x0a000000u), 8 };
+	ipv4_network private_subnet{ htonl(0x0a010000u), 16 };
+	ipv4_network loopback_net{ htonl(INADDR_LOOPBACK), 8 };
+	ipv4_network loopback{ htonl(INADDR_LOOPBACK), 32 };
+
+	std::vector<std::pair<ipv4_network, std::string>> const entries{
+		{ any, "default" },
+		{ private_net, "private" },
+		{ private_subnet, "private subnet" },
+		{ ipv4_network{ htonl(0x0a010200u), 24 }, "private /24" },
+	};
+	routing_table.insert_or_assign(entries.begin(), entries.end());
+	routing_table.insert_or_assign(loopback_net, "loopback");
+	std::cout << routing_table.insert(loopback_net, "loopback").second << "\n";
+
+	std::cout << *routing_table.value(loopback) << "\n";
+	std::cout << *routing_table.value(ipv4_network{ htonl(0x0a010204u) }) << "\n";
+	std::cout << *routing_table.value(ipv4_network{ htonl(0x0a020304u) }) << "\n";
+	std::cout << *routing_table.value(ipv4_network{ htonl(0xc0000201u) }) << "\n";
+
+	routing_table.erase(private_subnet);
+	std::cout << *routing_table.value(ipv4_network{ htonl(0x0a01ff01u) }) << "\n";
+
+	for (auto const& elem: routing_table) {
+		std::cout << "entry: " << to_string(elem.key()) << ": " << elem.value() << "\n";
+	}
+	std::cout << "lengths: " << routing_table.length_count() << "\n";
+}
+
+void run_ipv6_network() {
+	bloom_filtered_table<ipv6_network, std::string, ipv6_network_bitstring_traits, radix_tree<ipv6_network, std::string, ipv6_network_bitstring_traits>> routing_table;
+	routing_table.insert_or_assign(ipv6_network{0, 0, 0}, "default");
+	routing_table.insert_or_assign(ipv6_network{0x20010db800000000u, 0, 32}, "documentation");
+	routing_table.insert_or_assign(ipv6_network{0x20010db800010000u, 0, 48}, "site");
+	routing_table.insert_or_assign(ipv6_network{0x20010db800010001u, 0, 64}, "subnet");
+
+	std::cout << *routing_table.value(ipv6_network{0x20010db800010001u, 1}) << "\n";
+	std::cout << *routing_table.value(ipv6_network{0x20010db800010002u, 1}) << "\n";
+	std::cout << *routing_table.value(ipv6_network{0x20010db800020000u, 1}) << "\n";
+	std::cout << *routing_table.value(in6addr_loopback) << "\n";
+	std::cout << "lengths: " << routing_table.length_count() << "\n";
+}
+
+void run_false_positives() {
+	// one counter per key: most counters are set, so about half of the lengths without a
+	// match pass the filter, and lookups have to skip these false positives in the table
+	bloom_filtered_table<ipv4_network, uint32_t, ipv4_network_bitstring_traits> routing_table(1);
+	routing_table.insert(ipv4_network{0, 0}, 0);
+	routing_table.insert(ipv4_network{ htonl(0x0a000000u), 8 }, 8);
+	for (uint32_t i = 0; i < 256; ++i) {
+		routing_table.insert(ipv4_network{ htonl(0x0a000000u | (i << 16) | (i << 8)), 24 }, 24);
+		routing_table.insert(ipv4_network{ htonl(0x0b000000u | (i << 8) | i), 32 }, 32);
+	}
+
+	size_t mismatches = 0;
+	size_t results[33] = {};
+	for (uint32_t i = 0; i < 4096; ++i) {
+		// 10.i.j.k (mostly without /24) and 11.0.j.k (mostly without /32)
+		uint32_t const address = ((i & 1) ? 0x0a000000u : 0x0b000000u) | (i * 0x9e3779b1u & 0x00ffffffu);
+		ipv4_network const key{ htonl(address) };
+		uint32_t const* const filtered = routing_table.value(key);
+		uint32_t const* const expected = routing_table.table().value(key);
+		if (!filtered || !expected || *filtered != *expected) ++mismatches;
+		if (filtered) ++results[*filtered];
+	}
+	std::cout << "mismatches: " << mismatches << ", /0: " << results[0] << ", /8: " << results[8]
+		<< ", /24: " << results[24] << ", /32: " << results[32] << "\n";
+}
+
+int main() {
+	run_ipv4_network();
+	run_false_positives();
+	run_ipv6_network();
+	return 0;
+}
@@ -0,0 +1,76 @@
+#include "compressed_prefix_vector.hpp"
+#include "bigendian_bitstring.hpp"
+#include "ipv6_network.hpp"
+#include "prefix_vector.hpp"
+
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <netinet/ip6.h>
+
+struct my_ipv6_network {
+	in6_addr addr;
+	uint8_t prefix;
+};
+
+struct my_ipv6_network_bitstring_traits {
+	typedef bigendian::bitstring bitstring;
+	typedef my_ipv6_network value_type;
+
+	bitstring value_to_bitstring(value_type const& value) {
+		return bigendian::bitstring(value.addr.s6_addr, size_t{value.prefix});
+	}
+
+	value_type bitstring_to_value(bitstring bs) {
+		bs = bs.truncate(128);
+		my_ipv6_network result{in6addr_any, static_cast<uint8_t>(bs.length())};
+		bs.set_bitstring(result.addr.s6_addr, sizeof(result.addr.s6_addr));
+		return result;
+	}
+
+	// full length bitstring for lookups by address
+	bitstring address_to_bitstring(in6_addr const& address) {
+		return bigendian::bitstring(address.s6_addr, 128);
+	}
+};
+
+std::string to_string(my_ipv6_network const& val) {
+	return to_string(ipv6_network(val.addr, val.prefix));
+}
+
+my_ipv6_network make_network(uint64_t high, unsigned char prefix) {
+	return my_ipv6_network{ipv6_network(high, 0).address(), prefix};
+}
+
+int main() {
+	prefix_vector<my_ipv6_network, std::string, my_ipv6_network_bitstring_traits> source;
+	std::vector<std::pair<my_ipv6_network, std::string>> const entries{
+		{ make_network(0, 0), "default" },
+		{ make_network(0x20010db800000000u, 32), "documentation" },
+		{ make_network(0x20010db800010000u, 48), "site 1" },
+		{ make_network(0x20010db800010001u, 64), "site 1 subnet 1" },
+		{ make_network(0x20010db800010002u, 64), "site 1 subnet 2" },
+		{ make_network(0x20010db800020000u, 48), "site 2" },
+		{ make_network(0x20010db800020001u, 64), "site 2 subnet 1" },
+	};
+	source.insert_or_assign(entries.begin(), entries.end());
+
+	// small blocks to get more than one
+	compressed_prefix_vector<my_ipv6_network, std::string, my_ipv6_network_bitstring_traits, 4> const routing_table(source);
+
+	std::cout << *routing_table.value(make_network(0x20010db800010001u, 128)) << "\n";
+	std::cout << *routing_table.value(make_network(0x20010db800010003u, 128)) << "\n";
+	std::cout << *routing_table.value(make_network(0x20010db800020001u, 128)) << "\n";
+	std::cout << *routing_table.value(make_network(0x20010db800030000u, 128)) << "\n";
+	std::cout << *routing_table.value(in6addr_loopback) << "\n";
+	std::cout << (nullptr != routing_table.value_exact(make_network(0x20010db800020000u, 48))) << "\n";
+	std::cout << (nullptr != routing_table.value_exact(make_network(0x20010db800020000u, 56))) << "\n";
+
+	routing_table.for_each([](my_ipv6_network const& key, std::string const& value) {
+		std::cout << "entry: " << to_string(key) << ": " << value << "\n";
+	});
+	std::cout << "key bytes: " << routing_table.key_memory_usage() << " for " << routing_table.size() << " keys\n";
+	return 0;
+}
@@ -0,0 +1,68 @@
+#include "dual_stack_table.hpp"
+#include "radix_tree.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <netinet/ip.h>
+
+void run_dual_stack_table() {
+	dual_stack_table<std::string> routing_table;
+	ipv4_network any4{0, 0};
+	ipv4_network loopback_net{ htonl(INADDR_LOOPBACK), 8 };
+	ipv4_network loopback{ htonl(INADDR_LOOPBACK), 32 };
+	ipv6_network any6{0, 0, 0};
+	ipv6_network documentation_net{0x20010db800000000u, 0, 32};
+	ipv6_network host{0x20010db800010000u, 1};
+
+	routing_table.insert_or_assign(any4, "default v4");
+	routing_table.insert_or_assign(loopback_net, "loopback");
+	routing_table.insert_or_assign(any6, "default v6");
+	std::cout << routing_table.insert(documentation_net, "documentation") << "\n";
+	std::cout << routing_table.insert(documentation_net, "documentation") << "\n";
+
+	std::cout << *routing_table.value(loopback) << "\n";
+	std::cout << *routing_table.value(host) << "\n";
+	std::cout << *routing_table.value(ipv6_network{in6addr_loopback}) << "\n";
+
+	std::vector<ip_network> const batch{ loopback, host, ipv4_network{ htonl(0x0a000001u) }, any6 };
+	std::vector<std::string const*> results(batch.size());
+	routing_table.values(batch.begin(), batch.end(), results.begin());
+	for (auto const* result: results) {
+		std::cout << "batch: " << *result << "\n";
+	}
+
+	auto const snapshot = routing_table.snapshot();
+	routing_table.erase(loopback_net);
+	std::cout << *routing_table.value(loopback) << "\n";
+	std::cout << *snapshot.value(loopback) << "\n";
+
+	snapshot.for_each([](ip_network const& key, std::string const& value) {
+		std::cout << "entry: " << to_string(key) << ": " << value << "\n";
+	});
+
+	auto const stats = snapshot.statistics();
+	std::cout << "size: " << stats.ipv4_size << " + " << stats.ipv6_size << "\n";
+}
+
+void run_dual_stack_radix_tree() {
+	dual_stack_table<std::string,
+		radix_tree<ipv4_network, std::string, ipv4_network_bitstring_traits>,
+		radix_tree<ipv6_network, std::string, ipv6_network_bitstring_traits>> routing_table;
+	routing_table.insert_or_assign(ipv4_network{ htonl(INADDR_LOOPBACK), 8 }, "loopback");
+	routing_table.insert_or_assign(ipv6_network{in6addr_loopback}, "loopback v6");
+
+	std::cout << *routing_table.value(ipv4_network{ htonl(INADDR_LOOPBACK) }) << "\n";
+	std::cout << *routing_table.value(ipv6_network{in6addr_loopback}) << "\n";
+	std::cout << (nullptr == routing_table.value(ipv6_network{0x20010db800010000u, 1})) << "\n";
+
+	auto const stats = routing_table.snapshot().statistics();
+	std::cout << "size: " << stats.ipv4_size << " + " << stats.ipv6_size << "\n";
+}
+
+int main() {
+	run_dual_stack_table();
+	run_dual_stack_radix_tree();
+	return 0;
+}
@@ -0,0 +1,55 @@
+#include "interned_table.hpp"
+#include "ipv4_network.hpp"
+#include "radix_tree.hpp"
+
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <netinet/ip.h>
+
+void run_interned_table() {
+	interned_table<ipv4_network, std::string, ipv4_network_bitstring_traits> routing_table;
+	ipv4_network private_net{ htonl(0x0a000000u), 8 };
+	ipv4_network loopback_net{ htonl(INADDR_LOOPBACK), 8 };
+
+	std::vector<std::pair<ipv4_network, std::string>> const entries{
+		{ ipv4_network{0, 0}, "via 192.0.2.1 dev eth0" },
+		{ private_net, "via 198.51.100.1 dev eth1" },
+		{ ipv4_network{ htonl(0x0a010000u), 16 }, "via 198.51.100.1 dev eth1" },
+		{ ipv4_network{ htonl(0xc0a80000u), 16 }, "via 198.51.100.1 dev eth1" },
+	};
+	routing_table.insert_or_assign(entries.begin(), entries.end());
+	std::cout << routing_table.insert(loopback_net, "dev lo") << "\n";
+	std::cout << routing_table.insert(loopback_net, "dev lo") << "\n";
+	std::cout << "values: " << routing_table.value_count() << "\n";
+
+	std::cout << *routing_table.value(ipv4_network{ htonl(0x0a010203u) }) << "\n";
+	std::cout << *routing_table.value(htonl(INADDR_LOOPBACK)) << "\n";
+	// all entries with this next hop change at once
+	std::cout << routing_table.replace_value("via 198.51.100.1 dev eth1", "via 198.51.100.2 dev eth1") << "\n";
+	std::cout << *routing_table.value(ipv4_network{ htonl(0xc0a80101u) }) << "\n";
+
+	routing_table.erase(loopback_net);
+	routing_table.insert_or_assign(private_net, "via 192.0.2.1 dev eth0");
+	routing_table.for_each([](ipv4_network const& key, std::string const& value) {
+		std::cout << "entry: " << to_string(key) << ": " << value << "\n";
+	});
+	std::cout << "values: " << routing_table.value_count() << "\n";
+}
+
+void run_interned_radix_tree() {
+	interned_table<ipv4_network, std::string, ipv4_network_bitstring_traits, uint8_t, radix_tree<ipv4_network, uint8_t, ipv4_network_bitstring_traits>> routing_table;
+	for (uint32_t i = 0; i < 1000; ++i) {
+		routing_table.insert_or_assign(ipv4_network{ htonl(0x0a000000u | (i << 8)), 24 }, "gateway " + std::to_string(i % 4));
+	}
+	std::cout << "size: " << routing_table.size() << ", values: " << routing_table.value_count() << "\n";
+	std::cout << *routing_table.value(ipv4_network{ htonl(0x0a000a01u) }) << "\n";
+}
+
+int main() {
+	run_interned_table();
+	run_interned_radix_tree();
+	return 0;
+}
@@ -0,0 +1,62 @@
+#include "latency_histogram.hpp"
+
+#include <iostream>
+
+#include <stdint.h>
+
+// values below 2^SUB_BUCKET_BITS are exact: every percentile hits a recorded value
+void run_exact_values() {
+	latency_histogram histogram;
+	for (uint64_t value = 0; value < 128; ++value) histogram.record(value);
+
+	bool exact = true;
+	for (uint64_t value = 0; value < 128; ++value) {
+		double const percentile = 100.0 * static_cast<double>(value + 1) / 128.0;
+		if (histogram.value_at_percentile(percentile) != value) exact = false;
+	}
+	std::cout << "exact below 128: " << exact << "\n";
+	std::cout << "min: " << histogram.min() << ", max: " << histogram.max() << ", mean: " << histogram.mean() << "\n";
+}
+
+// larger values are rounded up by less than 2^-(SUB_BUCKET_BITS - 1)
+void run_relative_error() {
+	double worst = 0;
+	bool bounded = true;
+	for (uint64_t value = 128; value < (uint64_t{1} << 40); value = value + value / 7 + 1) {
+		latency_histogram histogram;
+		histogram.record(value);
+		// p100 is clamped to the maximum; look at the bucket bound through a larger second value
+		histogram.record(value * 4);
+		uint64_t const reported = histogram.value_at_percentile(50);
+		if (reported < value) bounded = false;
+		double const error = static_cast<double>(reported - value) / static_cast<double>(value);
+		if (error >= 1.0 / 64) bounded = false;
+		if (error > worst) worst = error;
+	}
+	std::cout << "relative error bounded: " << bounded << ", worst below 1/64: " << (worst < 1.0 / 64) << "\n";
+}
+
+void run_percentiles() {
+	latency_histogram histogram;
+	for (uint64_t value = 1; value <= 1000; ++value) histogram.record(value * 1000);
+	histogram.record(123456789);
+
+	std::cout << "count: " << histogram.count() << "\n";
+	std::cout << "p100 is max: " << (histogram.value_at_percentile(100) == histogram.max()) << "\n";
+	std::cout << "p50: " << histogram.value_at_percentile(50) << "\n";
+	std::cout << "p99: " << histogram.value_at_percentile(99) << "\n";
+
+	latency_histogram other;
+	other.record(5);
+	histogram.merge(other);
+	std::cout << "merged min: " << histogram.min() << ", count: " << histogram.count() << "\n";
+	histogram.clear();
+	std::cout << "cleared: " << histogram.count() << " " << histogram.value_at_percentile(50) << "\n";
+}
+
+int main() {
+	run_exact_values();
+	run_relative_error();
+	run_percentiles();
+	return 0;
+}
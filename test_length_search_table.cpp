@@ -0,0 +1,95 @@
+#include "length_search_table.hpp"
+#include "ipv4_network.hpp"
+#include "ipv6_network.hpp"
+
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <netinet/ip.h>
+
+void run_ipv4_network() {
+	length_search_table<ipv4_network, std::string, ipv4_network_bitstring_traits> routing_table;
+	ipv4_network any{0, 0};
+	ipv4_network private_net{ htonl(0x0a000000u), 8 };
+	ipv4_network private_subnet{ htonl(0x0a010000u), 16 };
+	ipv4_network loopback_net{ htonl(INADDR_LOOPBACK), 8 };
+	ipv4_network loopback{ htonl(INADDR_LOOPBACK), 32 };
+
+	std::vector<std::pair<ipv4_network, std::string>> const entries{
+		{ any, "default" },
+		{ private_net, "private" },
+		{ private_subnet, "private subnet" },
+		{ ipv4_network{ htonl(0x0a010200u), 24 }, "private /24" },
+		{ ipv4_network{ htonl(0x0a010203u), 32 }, "private host" },
+	};
+	routing_table.insert_or_assign(entries.begin(), entries.end());
+	routing_table.insert_or_assign(loopback_net, "loopback");
+	std::cout << routing_table.insert(loopback_net, "loopback").second << "\n";
+
+	std::cout << *routing_table.value(loopback) << "\n";
+	std::cout << *routing_table.value(ipv4_network{ htonl(0x0a010204u) }) << "\n";
+	std::cout << *routing_table.value(ipv4_network{ htonl(0x0a010203u) }) << "\n";
+	std::cout << *routing_table.value(ipv4_network{ htonl(0x0a020304u) }) << "\n";
+	std::cout << routing_table.find(htonl(0xc0000201u))->value() << "\n";
+	std::cout << (routing_table.find_exact(private_subnet) != routing_table.end()) << "\n";
+	std::cout << (routing_table.find_exact(ipv4_network{ htonl(0x0a010000u), 17 }) != routing_table.end()) << "\n";
+
+	routing_table.erase(private_subnet);
+	std::cout << *routing_table.value(ipv4_network{ htonl(0x0a01ff01u) }) << "\n";
+
+	for (auto const& elem: routing_table) {
+		std::cout << "entry: " << to_string(elem.key()) << ": " << elem.value() << "\n";
+	}
+	std::cout << "lengths: " << routing_table.length_count() << ", markers: " << routing_table.marker_count() << "\n";
+}
+
+void run_ipv6_network() {
+	length_search_table<ipv6_network, std::string, ipv6_network_bitstring_traits> routing_table;
+	routing_table.insert_or_assign(ipv6_network{0, 0, 0}, "default");
+	routing_table.insert_or_assign(ipv6_network{0x20010db800000000u, 0, 32}, "documentation");
+	routing_table.insert_or_assign(ipv6_network{0x20010db800010000u, 0, 48}, "site");
+	routing_table.insert_or_assign(ipv6_network{0x20010db800010001u, 0, 64}, "subnet");
+
+	std::cout << *routing_table.value(ipv6_network{0x20010db800010001u, 1}) << "\n";
+	std::cout << *routing_table.value(ipv6_network{0x20010db800010002u, 1}) << "\n";
+	std::cout << *routing_table.value(ipv6_network{0x20010db800020000u, 1}) << "\n";
+	std::cout << *routing_table.value(in6addr_loopback) << "\n";
+	std::cout << "lengths: " << routing_table.length_count() << ", markers: " << routing_table.marker_count() << "\n";
+}
+
+void run_marker_fallback() {
+	// the lookup for 10.1.2.4 hits the marker 10.1.0.0/16 left by the /32, fails at /32
+	// and has to return the best matching prefix stored with the marker
+	length_search_table<ipv4_network, std::string, ipv4_network_bitstring_traits> routing_table;
+	ipv4_network private_net{ htonl(0x0a000000u), 8 };
+	ipv4_network private_subnet{ htonl(0x0a010000u), 16 };
+	std::vector<std::pair<ipv4_network, std::string>> const entries{
+		{ ipv4_network{0, 0}, "default" },
+		{ private_net, "private" },
+		{ ipv4_network{ htonl(0xc0a80000u), 16 }, "192.168/16" },
+		{ ipv4_network{ htonl(0x0a010203u), 32 }, "private host" },
+	};
+	routing_table.insert(entries.begin(), entries.end());
+	ipv4_network const address{ htonl(0x0a010204u) };
+	std::cout << *routing_table.value(address) << ", markers: " << routing_table.marker_count() << "\n";
+
+	// the marker becomes a real entry and back
+	routing_table.insert(private_subnet, "private subnet");
+	std::cout << *routing_table.value(address) << ", markers: " << routing_table.marker_count() << "\n";
+	routing_table.erase(private_subnet);
+	std::cout << *routing_table.value(address) << ", markers: " << routing_table.marker_count() << "\n";
+
+	// erasing the best matching prefix of the marker
+	routing_table.erase(private_net);
+	std::cout << *routing_table.value(address) << ", markers: " << routing_table.marker_count() << "\n";
+	std::cout << *routing_table.value(ipv4_network{ htonl(0x0a010203u) }) << "\n";
+}
+
+int main() {
+	run_ipv4_network();
+	run_marker_fallback();
+	run_ipv6_network();
+	return 0;
+}
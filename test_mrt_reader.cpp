@@ -0,0 +1,110 @@
+#include "mrt_reader.hpp"
+#include "prefix_vector.hpp"
+#include "radix_tree.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <arpa/inet.h>
+
+namespace {
+	void put_u16(std::vector<unsigned char>& out, uint16_t value) {
+		out.push_back(static_cast<unsigned char>(value >> 8));
+		out.push_back(static_cast<unsigned char>(value));
+	}
+
+	void put_u32(std::vector<unsigned char>& out, uint32_t value) {
+		put_u16(out, static_cast<uint16_t>(value >> 16));
+		put_u16(out, static_cast<uint16_t>(value));
+	}
+
+	void put_record(std::vector<unsigned char>& out, uint16_t type, uint16_t subtype, std::vector<unsigned char> const& body) {
+		put_u32(out, 0); // timestamp
+		put_u16(out, type);
+		put_u16(out, subtype);
+		put_u32(out, static_cast<uint32_t>(body.size()));
+		out.insert(out.end(), body.begin(), body.end());
+	}
+
+	// RIB record with one entry per given next hop; IPv4 next hops use NEXT_HOP, IPv6 the abbreviated MP_REACH_NLRI
+	std::vector<unsigned char> rib_body(uint32_t sequence, unsigned char prefix_length, std::vector<unsigned char> const& prefix, std::vector<std::vector<unsigned char>> const& next_hops) {
+		std::vector<unsigned char> body;
+		put_u32(body, sequence);
+		body.push_back(prefix_length);
+		body.insert(body.end(), prefix.begin(), prefix.begin() + (prefix_length + 7) / 8);
+		put_u16(body, static_cast<uint16_t>(next_hops.size()));
+		uint16_t peer = 0;
+		for (auto const& next_hop: next_hops) {
+			put_u16(body, peer++);
+			put_u32(body, 0); // originated time
+			std::vector<unsigned char> attributes{ 0x40, 1, 1, 0 }; // ORIGIN: IGP
+			if (4 == next_hop.size()) {
+				attributes.insert(attributes.end(), { 0x40, 3, 4 });
+			} else {
+				attributes.insert(attributes.end(), { 0x80, 14, static_cast<unsigned char>(next_hop.size() + 1), static_cast<unsigned char>(next_hop.size()) });
+			}
+			attributes.insert(attributes.end(), next_hop.begin(), next_hop.end());
+			put_u16(body, static_cast<uint16_t>(attributes.size()));
+			body.insert(body.end(), attributes.begin(), attributes.end());
+		}
+		return body;
+	}
+
+	std::string first_next_hop(mrt_rib_record const& record) {
+		size_t offset = 0;
+		mrt_rib_entry entry;
+		if (!record.next_entry(offset, entry)) return "none";
+
+		unsigned char const* value;
+		size_t value_length;
+		char buf[INET6_ADDRSTRLEN];
+		if (find_bgp_attribute(entry.attributes, entry.attributes_length, 3, value, value_length) && 4 == value_length) {
+			return inet_ntop(AF_INET, value, buf, sizeof(buf));
+		}
+		if (find_bgp_attribute(entry.attributes, entry.attributes_length, 14, value, value_length) && 17 == value_length) {
+			return inet_ntop(AF_INET6, value + 1, buf, sizeof(buf));
+		}
+		return "none";
+	}
+}
+
+void run_mrt_reader() {
+	std::vector<unsigned char> const next_hop_a{ 192, 0, 2, 1 };
+	std::vector<unsigned char> const next_hop_b{ 192, 0, 2, 2 };
+	std::vector<unsigned char> const next_hop_v6{ 0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1 };
+
+	std::vector<unsigned char> dump;
+	put_record(dump, 13, 1, { 192, 0, 2, 254, 0, 0, 0, 0 }); // PEER_INDEX_TABLE (no peers), skipped
+	put_record(dump, 13, 2, rib_body(0, 8, { 10 }, { next_hop_a, next_hop_b }));
+	put_record(dump, 16, 4, { 0, 0, 0, 0 }); // BGP4MP, skipped
+	put_record(dump, 13, 2, rib_body(1, 24, { 10, 1, 2 }, { next_hop_b }));
+	put_record(dump, 13, 4, rib_body(2, 32, { 0x20, 0x01, 0x0d, 0xb8 }, { next_hop_v6 }));
+
+	prefix_vector<ipv4_network, std::string, ipv4_network_bitstring_traits> ipv4_table;
+	radix_tree<ipv6_network, std::string, ipv6_network_bitstring_traits> ipv6_table;
+
+	mrt_reader reader(dump.data(), dump.size());
+	size_t const count = load_mrt_rib(reader, ipv4_table, ipv6_table, first_next_hop, 2);
+	std::cout << "records: " << count << ", error: " << reader.error() << "\n";
+
+	for (auto const& elem: ipv4_table) {
+		std::cout << "entry: " << to_string(elem.key()) << ": " << elem.value() << "\n";
+	}
+	for (auto const& elem: ipv6_table) {
+		std::cout << "entry: " << to_string(elem.key()) << ": " << elem.value() << "\n";
+	}
+
+	// truncated dump
+	mrt_reader truncated(dump.data(), dump.size() - 1);
+	mrt_rib_record record;
+	while (truncated.next(record)) {
+		std::cout << "record: " << to_string(record.prefix()) << " (" << record.entry_count() << " entries)\n";
+	}
+	std::cout << "truncated error: " << truncated.error() << "\n";
+}
+
+int main() {
+	run_mrt_reader();
+	return 0;
+}
@@ -0,0 +1,92 @@
+#include "numa_replicated.hpp"
+#include "ipv4_network.hpp"
+#include "numa_topology.hpp"
+#include "prefix_vector.hpp"
+#include "radix_tree.hpp"
+
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <netinet/ip.h>
+
+void run_topology() {
+	std::cout << "system: " << numa_topology::system().node_count() << " node(s)\n";
+
+	std::vector<int> ids;
+	std::cout << parse_id_list("0-3,8,10-11\n", 12, ids) << ":";
+	for (int id: ids) std::cout << " " << id;
+	std::cout << "\n";
+	std::cout << parse_id_list("3-1", 3, ids) << "\n";
+
+	// no sysfs: single node with all cpus
+	std::cout << "fallback: " << numa_topology::read("/nonexistent").node_count() << " node(s)\n";
+
+	numa_topology const topology({ { 0, 1 }, {}, { 2, 3 } });
+	std::cout << to_string(topology) << "\n";
+	std::cout << "cpu 3 on node " << topology.node_of_cpu(3) << "\n";
+}
+
+void run_ipv4_network() {
+	prefix_vector<ipv4_network, std::string, ipv4_network_bitstring_traits> source;
+	source.insert_or_assign(ipv4_network{0, 0}, "default");
+	source.insert_or_assign(ipv4_network{ htonl(INADDR_LOOPBACK), 8 }, "loopback");
+
+	numa_replicated<decltype(source)> routing_table;
+	std::string value;
+	std::cout << routing_table.value(ipv4_network{ htonl(INADDR_LOOPBACK) }, value) << "\n";
+
+	routing_table.publish(source);
+	if (routing_table.value(ipv4_network{ htonl(INADDR_LOOPBACK) }, value)) std::cout << value << "\n";
+	if (routing_table.value(htonl(0xc0000201u), value)) std::cout << "by address: " << value << "\n";
+
+	// published copies don't change with the source
+	source.insert_or_assign(ipv4_network{ htonl(0x0a000000u), 8 }, "private");
+	if (routing_table.value(ipv4_network{ htonl(0x0a010203u) }, value)) std::cout << value << "\n";
+	routing_table.publish(source);
+	if (routing_table.value(ipv4_network{ htonl(0x0a010203u) }, value)) std::cout << value << "\n";
+	std::cout << "generation: " << routing_table.generation() << "\n";
+}
+
+// copies built on one thread per node (two nodes sharing the cpus of the system here), while
+// other threads keep looking up
+void run_parallel_publish() {
+	auto const& cpus = numa_topology::system().cpus(0);
+	numa_topology const topology({ cpus, cpus });
+
+	radix_tree<ipv4_network, uint32_t, ipv4_network_bitstring_traits> source;
+	source.insert_or_assign(ipv4_network{0, 0}, 0);
+	numa_replicated<decltype(source)> routing_table(topology);
+	routing_table.publish(source);
+
+	std::atomic<bool> done{false};
+	std::atomic<size_t> missing{0};
+	std::vector<std::thread> readers;
+	for (int t = 0; t < 2; ++t) {
+		readers.emplace_back([&]() {
+			uint32_t value;
+			while (!done) {
+				if (!routing_table.value(ipv4_network{ htonl(0xc0000201u) }, value)) ++missing;
+			}
+		});
+	}
+	for (uint32_t i = 1; i <= 20; ++i) {
+		source.insert_or_assign(ipv4_network{ htonl(i << 24), 8 }, i);
+		routing_table.publish(source);
+	}
+	done = true;
+	for (auto& thread: readers) thread.join();
+
+	std::cout << "nodes: " << routing_table.node_count() << ", generation: " << routing_table.generation() << ", missing: " << missing << "\n";
+	std::cout << "separate copies: " << (routing_table.replica(0) != routing_table.replica(1)) << "\n";
+	std::cout << "size: " << routing_table.replica()->size() << "\n";
+}
+
+int main() {
+	run_topology();
+	run_ipv4_network();
+	run_parallel_publish();
+	return 0;
+}
@@ -1,11 +1,27 @@
 #include "prefix_vector.hpp"
 #include "bigendian_bitstring.hpp"
+#include "cached_lookup.hpp"
+#include "fixed_prefix.hpp"
 #include "ipv4_network.hpp"
+#include "ipv6_network.hpp"
+#include "mapped_file.hpp"
 
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/interprocess/allocators/allocator.hpp>
+#include <boost/interprocess/managed_external_buffer.hpp>
 
 #include <netinet/ip.h>
 #include <netinet/ip6.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 void run_ipv4_network() {
 	prefix_vector<ipv4_network, uint32_t, ipv4_network_bitstring_traits> routing_table;
@@ -21,6 +37,7 @@ void run_ipv4_network() {
 	std::cout << routing_table.find(loopback_net)->value() << "\n";
 	std::cout << routing_table.find(loopback)->value() << "\n";
 	std::cout << routing_table.find(null)->value() << "\n";
+	std::cout << "by address: " << *routing_table.value(ipv4_host_address{INADDR_LOOPBACK}) << "\n";
 
 	for (auto const& elem: routing_table.subkeys(loopback_net)) {
 		std::cout << "subkey: " << to_string(elem.key()) << ": " << elem.value() << "\n";
@@ -37,12 +54,181 @@ void run_ipv4_network() {
 		std::cout << "subkey: " << to_string(elem.key()) << ": " << elem.value() << "\n";
 	}
 
+	for (auto const& elem: const_routing_table.covering(loopback)) {
+		std::cout << "covering: " << to_string(elem.key()) << ": " << elem.value() << "\n";
+	}
+
+	for (auto const& elem: const_routing_table.overlapping(null, loopback)) {
+		std::cout << "overlapping: " << to_string(elem.key()) << ": " << elem.value() << "\n";
+	}
+
+	{
+		cached_lookup<decltype(routing_table)> cache(routing_table, 16);
+		std::cout << "cached: " << *cache.value(loopback) << "\n";
+		std::cout << "cached: " << *cache.value(loopback) << "\n";
+		routing_table.insert(loopback, 30);
+		std::cout << "cached after insert: " << *cache.value(loopback) << "\n";
+		routing_table.erase(loopback);
+		std::cout << "cached after erase: " << *cache.value(loopback) << "\n";
+		std::cout << "cache hits: " << cache.hits() << ", misses: " << cache.misses() << "\n";
+	}
+
 	using std::swap;
 	decltype(routing_table) other_routing_table;
 	swap(routing_table, other_routing_table);
 }
 
 
+void run_ipv6_network() {
+	prefix_vector<ipv6_network, uint32_t, ipv6_network_bitstring_traits> routing_table;
+	ipv6_network any{0, 0, 0};
+	ipv6_network documentation_net{0x20010db800000000u, 0, 32};
+	ipv6_network documentation_sub{0x20010db800010000u, 0, 48};
+	ipv6_network host{0x20010db800010000u, 1};
+	ipv6_network loopback{in6addr_loopback};
+
+	routing_table.insert_or_assign(any, 20);
+	routing_table.insert_or_assign(documentation_net, 10);
+	routing_table.insert_or_assign(documentation_sub, 30);
+
+	std::cout << routing_table.find(any)->value() << "\n";
+	std::cout << routing_table.find(documentation_net)->value() << "\n";
+	std::cout << routing_table.find(host)->value() << "\n";
+	std::cout << routing_table.find(loopback)->value() << "\n";
+
+	for (auto const& elem: routing_table.subkeys(documentation_net)) {
+		std::cout << "subkey: " << to_string(elem.key()) << ": " << elem.value() << "\n";
+	}
+
+	std::vector<std::pair<ipv6_network, uint32_t>> const replacement{
+		{ ipv6_network{0x20010db800020000u, 0, 48}, 40 },
+		{ documentation_net, 11 },
+	};
+	routing_table.replace_subkeys(documentation_net, replacement.begin(), replacement.end());
+	std::cout << routing_table.find(host)->value() << "\n";
+	for (auto const& elem: routing_table.subkeys(documentation_net)) {
+		std::cout << "replaced subkey: " << to_string(elem.key()) << ": " << elem.value() << "\n";
+	}
+	std::vector<std::pair<ipv6_network, uint32_t>> const outside{
+		{ ipv6_network{0x20010db800030000u, 0, 48}, 50 },
+		{ any, 51 },
+	};
+	try {
+		routing_table.replace_subkeys(documentation_net, outside.begin(), outside.end());
+	} catch (std::invalid_argument const& e) {
+		std::cout << "rejected: " << e.what() << ", size: " << routing_table.size() << "\n";
+	}
+	std::cout << "erased: " << routing_table.erase_subkeys(documentation_net) << ", size: " << routing_table.size() << "\n";
+
+	std::cout << "try_emplace: " << routing_table.try_emplace(any, 21u).second << "\n";
+	std::cout << "try_emplace: " << routing_table.try_emplace(documentation_net, 12u).second << "\n";
+	// keys in order: end() is the right hint
+	routing_table.emplace_hint(routing_table.end(), documentation_sub, 31u);
+	routing_table.emplace_hint(routing_table.end(), ipv6_network{0x20010db800020000u, 0, 48}, 41u);
+	for (auto const& elem: routing_table) {
+		std::cout << "entry: " << to_string(elem.key()) << ": " << elem.value() << "\n";
+	}
+}
+
+void run_mac_prefix() {
+	typedef fixed_prefix<48, uint64_t> mac_prefix;
+	prefix_vector<mac_prefix, std::string, fixed_prefix_bitstring_traits<48, uint64_t>> vendor_table;
+	mac_prefix any{0, 0};
+	mac_prefix vendor{0x001b21000000u, 24};
+	mac_prefix device{0x001b21abcdefu};
+
+	vendor_table.insert_or_assign(any, "unknown");
+	vendor_table.insert_or_assign(vendor, "vendor");
+
+	std::cout << vendor_table.find(any)->value() << "\n";
+	std::cout << vendor_table.find(device)->value() << "\n";
+	std::cout << vendor_table.find(mac_prefix{0x001c21abcdefu})->value() << "\n";
+
+	for (auto const& elem: vendor_table) {
+		std::cout << "entry: " << to_string(elem.key()) << ": " << elem.value() << "\n";
+	}
+}
+
+void run_parse_networks() {
+	char path[] = "/tmp/test_prefix_vector.XXXXXX";
+	int fd = mkstemp(path);
+	if (-1 == fd) {
+		std::perror("mkstemp");
+		return;
+	}
+	char const text[] = "0.0.0.0/0\n10.0.0.0/8\r\n\n10.1.0.0/16\n10.1.2.3\n";
+	if (write(fd, text, sizeof(text) - 1) != static_cast<ssize_t>(sizeof(text) - 1)) std::perror("write");
+	close(fd);
+
+	mapped_file file;
+	if (!file.open(path)) std::perror("open");
+	unlink(path);
+
+	std::vector<ipv4_network> networks;
+	std::cout << "parsed all: " << (file.end() == parse_ipv4_networks(file.begin(), file.end(), networks)) << "\n";
+
+	prefix_vector<ipv4_network, size_t, ipv4_network_bitstring_traits> routing_table;
+	for (size_t i = 0; i < networks.size(); ++i) routing_table.insert(networks[i], i);
+
+	char buf[ipv4_network::max_string_length];
+	for (auto const& elem: routing_table) {
+		std::cout << "entry: " << std::string(buf, format_to(buf, elem.key())) << ": " << elem.value() << "\n";
+	}
+
+	char const* const malformed[] = { "10.0.0.256/8", "10.0.0.0/33", "10.0.0/8" };
+	for (char const* str: malformed) {
+		ipv4_network network;
+		std::cout << str << ": " << parse_ipv4_network(str, std::strlen(str), network) << "\n";
+	}
+
+	ipv6_network network6;
+	char const str6[] = "2001:db8::1/48";
+	if (parse_ipv6_network(str6, sizeof(str6) - 1, network6)) {
+		std::cout << str6 << ": " << to_string(network6) << "\n";
+	}
+}
+
+// build a table in a memfd segment and read it through a second mapping of the segment at
+// a different address (like another process would)
+void run_shared_memory() {
+	namespace bip = boost::interprocess;
+	typedef bip::allocator<uint32_t, bip::managed_external_buffer::segment_manager> shm_allocator;
+	typedef prefix_vector<ipv4_network, uint32_t, ipv4_network_bitstring_traits, shm_allocator> shm_table;
+
+	size_t const size = size_t{1} << 20;
+	int fd = memfd_create("test_prefix_vector", 0);
+	if (-1 == fd) {
+		std::perror("memfd_create");
+		return;
+	}
+	if (-1 == ftruncate(fd, static_cast<off_t>(size))) std::perror("ftruncate");
+	void* writer_mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	void* reader_mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (MAP_FAILED == writer_mapping || MAP_FAILED == reader_mapping) {
+		std::perror("mmap");
+		return;
+	}
+
+	{
+		bip::managed_external_buffer segment(bip::create_only, writer_mapping, size);
+		shm_table* routing_table = segment.construct<shm_table>("routing_table")(shm_allocator(segment.get_segment_manager()));
+		routing_table->insert_or_assign(ipv4_network{0, 0}, 20);
+		routing_table->insert_or_assign(ipv4_network{htonl(INADDR_LOOPBACK), 8}, 10);
+	}
+
+	{
+		bip::managed_external_buffer segment(bip::open_only, reader_mapping, size);
+		shm_table const* routing_table = segment.find<shm_table>("routing_table").first;
+		std::cout << "shared: " << routing_table->find(ipv4_network{htonl(INADDR_LOOPBACK), 32})->value() << "\n";
+		for (auto const& elem: *routing_table) {
+			std::cout << "shared entry: " << to_string(elem.key()) << ": " << elem.value() << "\n";
+		}
+	}
+
+	munmap(writer_mapping, size);
+	munmap(reader_mapping, size);
+}
 
 struct my_ipv4_network {
 	uint32_t addr;
@@ -53,7 +239,7 @@ struct my_ipv4_network_bitstring_traits {
 	typedef bigendian::bitstring bitstring;
 	typedef my_ipv4_network value_type;
 
-	bitstring value_to_bitstring(value_type value) {
+	bitstring value_to_bitstring(value_type const& value) {
 		return bigendian::bitstring(&value.addr, size_t{value.prefix});
 	}
 
@@ -102,8 +288,51 @@ void run_my_ipv4_network() {
 	swap(routing_table, other_routing_table);
 }
 
+// key owning its bytes (short strings are stored inline, and moving clears them)
+struct label_path {
+	std::string bytes;
+	size_t length;
+};
+
+struct label_path_bitstring_traits {
+	typedef bigendian::bitstring bitstring;
+	typedef label_path value_type;
+
+	bitstring value_to_bitstring(value_type const& value) {
+		return bigendian::bitstring(value.bytes.data(), value.length);
+	}
+
+	value_type bitstring_to_value(bitstring bs) {
+		label_path result{std::string((bs.length() + 7) / 8, '\0'), bs.length()};
+		bs.set_bitstring(&result.bytes[0], result.bytes.size());
+		return result;
+	}
+};
+
+void run_label_path() {
+	prefix_vector<label_path, uint32_t, label_path_bitstring_traits> table;
+	// inserted out of order, so the new elements become ancestors of existing ones
+	table.insert_or_assign(label_path{"\x0a\x01", 16}, 16);
+	table.insert_or_assign(label_path{"\x0a\x01\x02", 24}, 24);
+	table.insert_or_assign(label_path{"\x0a", 8}, 8);
+
+	label_path const address{"\x0a\x01\x02\x03", 32};
+	for (auto const& elem: table.covering(address)) {
+		std::cout << "label covering: " << elem.value() << "\n";
+	}
+	table.erase(label_path{"\x0a\x01", 16});
+	for (auto const& elem: table.covering(address)) {
+		std::cout << "label covering after erase: " << elem.value() << "\n";
+	}
+}
+
 int main() {
 	run_ipv4_network();
+	run_ipv6_network();
+	run_mac_prefix();
+	run_parse_networks();
+	run_shared_memory();
 	run_my_ipv4_network();
+	run_label_path();
 	return 0;
 }
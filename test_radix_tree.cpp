@@ -1,6 +1,8 @@
 #include "radix_tree.hpp"
 #include "bigendian_bitstring.hpp"
+#include "fixed_prefix.hpp"
 #include "ipv4_network.hpp"
+#include "ipv6_network.hpp"
 
 #include <iostream>
 
@@ -20,6 +22,24 @@ void run_ipv4_network() {
 		for (auto const& elem: routing_table) {
 			std::cout << "entry: " << to_string(elem.key()) << ": " << elem.value() << "\n";
 		}
+
+		auto const frozen_routing_table = routing_table.freeze();
+		std::cout << "frozen size: " << frozen_routing_table.size() << "\n";
+		for (auto const& elem: frozen_routing_table) {
+			std::cout << "frozen entry: " << to_string(elem.key()) << ": " << elem.value() << "\n";
+		}
+		std::cout << *frozen_routing_table.value(ipv4_network(htonl(0x0a000301u), 32)) << "\n";
+		std::cout << (frozen_routing_table.find(ipv4_network(htonl(0x0a000601u), 32)) == frozen_routing_table.end()) << "\n";
+
+		// 10.0.0.0/22 covers the first three entries
+		auto extracted = routing_table.extract_subtree(ipv4_network(htonl(0x0a000000u), 22));
+		std::cout << "extracted: " << extracted.size() << ", left: " << routing_table.size() << "\n";
+		routing_table.splice(extracted);
+		std::cout << "spliced: " << routing_table.size() << ", left: " << extracted.size() << "\n";
+		std::cout << "erased: " << routing_table.erase_subtree(ipv4_network(htonl(0x0a000400u), 23)) << "\n";
+		for (auto const& elem: routing_table) {
+			std::cout << "entry: " << to_string(elem.key()) << ": " << elem.value() << "\n";
+		}
 	}
 
 	radix_tree<ipv4_network, std::string, ipv4_network_bitstring_traits> routing_table;
@@ -36,6 +56,7 @@ void run_ipv4_network() {
 	std::cout << *routing_table.value(loopback_net) << "\n";
 	std::cout << *routing_table.value(loopback) << "\n";
 	std::cout << *routing_table.value(null) << "\n";
+	std::cout << "by address: " << routing_table.find(htonl(INADDR_LOOPBACK))->value() << "\n";
 
 	std::cout << "size: " << routing_table.size() << "\n";
 	for (auto const& elem: routing_table) {
@@ -61,12 +82,91 @@ void run_ipv4_network() {
 		std::cout << "subkey: " << to_string(elem.key()) << ": " << elem.value() << "\n";
 	}
 
+	auto const frozen_routing_table = routing_table.freeze();
+
+	std::cout << *frozen_routing_table.value(any) << "\n";
+	std::cout << *frozen_routing_table.value(loopback_net) << "\n";
+	std::cout << frozen_routing_table.find(loopback)->value() << "\n";
+	std::cout << frozen_routing_table.find(null)->value() << "\n";
+	std::cout << (frozen_routing_table.find_exact(loopback) == frozen_routing_table.end()) << "\n";
+
+	for (auto const& elem: frozen_routing_table.find_all(loopback_net)) {
+		std::cout << "frozen subkey: " << to_string(elem.key()) << ": " << elem.value() << "\n";
+	}
+
+	for (auto const& elem: const_routing_table.covering(loopback)) {
+		std::cout << "covering: " << to_string(elem.key()) << ": " << elem.value() << "\n";
+	}
+
+	for (auto const& elem: const_routing_table.overlapping(null, loopback)) {
+		std::cout << "overlapping: " << to_string(elem.key()) << ": " << elem.value() << "\n";
+	}
+
+	for (auto const& elem: frozen_routing_table.covering(loopback)) {
+		std::cout << "frozen covering: " << to_string(elem.key()) << ": " << elem.value() << "\n";
+	}
+
 	using std::swap;
 	decltype(routing_table) other_routing_table;
 	swap(routing_table, other_routing_table);
 }
 
 
+void run_ipv6_network() {
+	radix_tree<ipv6_network, std::string, ipv6_network_bitstring_traits> routing_table;
+	ipv6_network any{0, 0, 0};
+	ipv6_network documentation_net{0x20010db800000000u, 0, 32};
+	ipv6_network documentation_sub{0x20010db800010000u, 0, 48};
+	ipv6_network host{0x20010db800010000u, 1};
+	ipv6_network loopback{in6addr_loopback};
+
+	routing_table.insert_or_assign(any, "20");
+	routing_table.insert_or_assign(documentation_net, "10");
+	routing_table.insert_or_assign(documentation_sub, "30");
+
+	std::cout << *routing_table.value(any) << "\n";
+	std::cout << *routing_table.value(documentation_net) << "\n";
+	std::cout << *routing_table.value(host) << "\n";
+	std::cout << *routing_table.value(loopback) << "\n";
+
+	std::cout << "size: " << routing_table.size() << "\n";
+	for (auto const& elem: routing_table) {
+		std::cout << "entry: " << to_string(elem.key()) << ": " << elem.value() << "\n";
+	}
+
+	for (auto const& elem: routing_table.find_all(documentation_net)) {
+		std::cout << "subkey: " << to_string(elem.key()) << ": " << elem.value() << "\n";
+	}
+
+	auto const generation = routing_table.generation();
+	std::cout << "try_emplace: " << routing_table.try_emplace(documentation_net, 2, '1').second << "\n";
+	// nothing changed: cached lookups stay valid
+	std::cout << "generation unchanged: " << (generation == routing_table.generation()) << "\n";
+	auto const pos = routing_table.try_emplace(ipv6_network{0x20010db800010000u, 2}, 2, '5').first;
+	// host goes just before pos: pos is the right hint
+	routing_table.emplace_hint(pos, host, 2, '4');
+	for (auto const& elem: routing_table.find_all(documentation_sub)) {
+		std::cout << "subkey: " << to_string(elem.key()) << ": " << elem.value() << "\n";
+	}
+}
+
+void run_mpls_label() {
+	typedef fixed_prefix<20, uint32_t> mpls_label;
+	radix_tree<mpls_label, std::string, fixed_prefix_bitstring_traits<20, uint32_t>> label_table;
+	label_table.insert_or_assign(mpls_label(0, 4), "reserved");
+	label_table.insert_or_assign(mpls_label(0x10000u, 4), "static");
+	label_table.insert_or_assign(mpls_label(0x18000u, 5), "dynamic");
+
+	std::cout << *label_table.value(mpls_label(3u)) << "\n";
+	std::cout << *label_table.value(mpls_label(0x10010u)) << "\n";
+	std::cout << *label_table.value(mpls_label(0x18010u)) << "\n";
+	std::cout << (nullptr == label_table.value(mpls_label(0x20010u))) << "\n";
+
+	for (auto const& elem: label_table) {
+		std::cout << "entry: " << to_string(elem.key()) << ": " << elem.value() << "\n";
+	}
+}
+
 
 struct my_ipv4_network {
 	uint32_t addr;
@@ -77,7 +177,7 @@ struct my_ipv4_network_bitstring_traits {
 	typedef bigendian::bitstring bitstring;
 	typedef my_ipv4_network value_type;
 
-	bitstring value_to_bitstring(value_type value) {
+	bitstring value_to_bitstring(value_type const& value) {
 		return bigendian::bitstring(&value.addr, size_t{value.prefix});
 	}
 
@@ -137,9 +237,30 @@ void run_my_ipv4_network() {
 	swap(routing_table, other_routing_table);
 }
 
+// erase under a valueless fork node which then only has a right child: the fork must be
+// replaced by that child, not dropped with it
+void run_erase_merge() {
+	radix_tree<ipv4_network, std::string, ipv4_network_bitstring_traits> routing_table;
+	routing_table.insert_or_assign(ipv4_network(htonl(0x0a000000u), 24), "0");
+	routing_table.insert_or_assign(ipv4_network(htonl(0x0a000100u), 24), "1");
+	routing_table.insert_or_assign(ipv4_network(htonl(0x0a000180u), 25), "1 high");
+	routing_table.erase(ipv4_network(htonl(0x0a000000u), 24));
+
+	size_t visited = 0;
+	for (auto const& elem: routing_table) {
+		std::cout << "entry: " << to_string(elem.key()) << ": " << elem.value() << "\n";
+		++visited;
+	}
+	std::cout << "size: " << routing_table.size() << ", visited: " << visited << "\n";
+	std::cout << *routing_table.value(ipv4_network(htonl(0x0a000181u), 32)) << "\n";
+}
+
 int main() {
 	run_ipv4_network();
+	run_ipv6_network();
+	run_mpls_label();
 	run_my_ipv4_network();
+	run_erase_merge();
 	return 0;
 }
 
@@ -0,0 +1,68 @@
+#include "sharded_prefix_table.hpp"
+#include "ipv4_network.hpp"
+#include "radix_tree.hpp"
+
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <netinet/ip.h>
+
+void run_sharded_prefix_table() {
+	sharded_prefix_table<ipv4_network, std::string, ipv4_network_bitstring_traits> routing_table;
+	ipv4_network any{0, 0};
+	ipv4_network private_net{ htonl(0x0a000000u), 8 };
+	ipv4_network loopback_net{ htonl(INADDR_LOOPBACK), 8 };
+	ipv4_network loopback{ htonl(INADDR_LOOPBACK), 32 };
+
+	routing_table.insert_or_assign(any, "default");
+	routing_table.insert_or_assign(loopback_net, "loopback");
+	std::cout << routing_table.insert(private_net, "private") << "\n";
+	std::cout << routing_table.insert(private_net, "private") << "\n";
+
+	std::string value;
+	if (routing_table.value(loopback, value)) std::cout << value << "\n";
+	if (routing_table.value(ipv4_network{ htonl(0x0a010203u) }, value)) std::cout << value << "\n";
+	// the default route is replicated into every shard
+	if (routing_table.value(ipv4_network{ htonl(0xc0000201u) }, value)) std::cout << value << "\n";
+	if (routing_table.value(htonl(INADDR_LOOPBACK), value)) std::cout << "by address: " << value << "\n";
+	std::cout << routing_table.value_exact(loopback, value) << "\n";
+
+	routing_table.erase(loopback_net);
+	if (routing_table.value(loopback, value)) std::cout << value << "\n";
+
+	routing_table.for_each([](ipv4_network const& key, std::string const& value) {
+		std::cout << "entry: " << to_string(key) << ": " << value << "\n";
+	});
+	std::cout << "size: " << routing_table.size() << "\n";
+}
+
+// several threads insert and erase in parallel (each in its own part of the address space)
+void run_parallel_updates() {
+	sharded_prefix_table<ipv4_network, uint32_t, ipv4_network_bitstring_traits, 8, radix_tree<ipv4_network, uint32_t, ipv4_network_bitstring_traits>> routing_table;
+	routing_table.insert_or_assign(ipv4_network{0, 0}, 0);
+
+	std::vector<std::thread> threads;
+	for (uint32_t t = 0; t < 4; ++t) {
+		threads.emplace_back([&routing_table, t]() {
+			for (uint32_t i = 0; i < 1000; ++i) {
+				ipv4_network const network{ htonl((t << 30) | (i << 16)), 16 };
+				routing_table.insert_or_assign(network, t + 1);
+				if (i % 2) routing_table.erase(network);
+			}
+		});
+	}
+	for (auto& thread: threads) thread.join();
+
+	uint32_t value{0};
+	std::cout << "size: " << routing_table.size() << "\n";
+	if (routing_table.value(ipv4_network{ htonl(0xc0000001u) }, value)) std::cout << value << "\n";
+	if (routing_table.value(ipv4_network{ htonl(0xc0010001u) }, value)) std::cout << value << "\n";
+}
+
+int main() {
+	run_sharded_prefix_table();
+	run_parallel_updates();
+	return 0;
+}
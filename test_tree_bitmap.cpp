@@ -0,0 +1,123 @@
+#include "tree_bitmap.hpp"
+#include "ipv4_network.hpp"
+#include "ipv6_network.hpp"
+
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <netinet/ip.h>
+#include <stdint.h>
+
+void run_ipv4_network() {
+	tree_bitmap<ipv4_network, std::string, ipv4_network_bitstring_traits> routing_table;
+	ipv4_network any{0, 0};
+	ipv4_network private_net{ htonl(0x0a000000u), 8 };
+	ipv4_network private_subnet{ htonl(0x0a010000u), 16 };
+	ipv4_network loopback_net{ htonl(INADDR_LOOPBACK), 8 };
+	ipv4_network loopback{ htonl(INADDR_LOOPBACK), 32 };
+
+	std::vector<std::pair<ipv4_network, std::string>> const entries{
+		{ any, "default" },
+		{ private_net, "private" },
+		{ private_subnet, "private subnet" },
+		{ ipv4_network{ htonl(0x0a010200u), 23 }, "private /23" },
+		{ ipv4_network{ htonl(0x0a010203u), 32 }, "private host" },
+	};
+	routing_table.insert_or_assign(entries.begin(), entries.end());
+	routing_table.insert_or_assign(loopback_net, "loopback");
+	std::cout << routing_table.insert(loopback_net, "loopback").second << "\n";
+
+	std::cout << *routing_table.value(loopback) << "\n";
+	std::cout << *routing_table.value(ipv4_network{ htonl(0x0a010304u) }) << "\n";
+	std::cout << *routing_table.value(ipv4_network{ htonl(0x0a010203u) }) << "\n";
+	std::cout << *routing_table.value(ipv4_network{ htonl(0x0a020304u) }) << "\n";
+	std::cout << *routing_table.value(htonl(0xc0000201u)) << "\n";
+	std::cout << (nullptr != routing_table.value_exact(private_subnet)) << "\n";
+	std::cout << (nullptr != routing_table.value_exact(ipv4_network{ htonl(0x0a010000u), 17 })) << "\n";
+
+	routing_table.erase(private_subnet);
+	routing_table.erase(ipv4_network{ htonl(0x0a010203u), 32 });
+	std::cout << *routing_table.value(ipv4_network{ htonl(0x0a01ff01u) }) << "\n";
+
+	routing_table.for_each([](ipv4_network const& key, std::string const& value) {
+		std::cout << "entry: " << to_string(key) << ": " << value << "\n";
+	});
+	std::cout << "nodes: " << routing_table.node_count() << "\n";
+}
+
+void run_ipv6_network() {
+	tree_bitmap<ipv6_network, std::string, ipv6_network_bitstring_traits> routing_table;
+	routing_table.insert_or_assign(ipv6_network{0, 0, 0}, "default");
+	routing_table.insert_or_assign(ipv6_network{0x20010db800000000u, 0, 32}, "documentation");
+	routing_table.insert_or_assign(ipv6_network{0x20010db800010000u, 0, 48}, "site");
+	routing_table.insert_or_assign(ipv6_network{0x20010db800010001u, 0, 64}, "subnet");
+
+	std::cout << *routing_table.value(ipv6_network{0x20010db800010001u, 1}) << "\n";
+	std::cout << *routing_table.value(ipv6_network{0x20010db800010002u, 1}) << "\n";
+	std::cout << *routing_table.value(ipv6_network{0x20010db800020000u, 1}) << "\n";
+	std::cout << *routing_table.value(in6addr_loopback) << "\n";
+	std::cout << "nodes: " << routing_table.node_count() << "\n";
+}
+
+void run_stride_boundaries() {
+	// with Stride 4: /3 is the longest prefix stored in the root, /4 the shortest in a
+	// child, /7 the longest in that child
+	tree_bitmap<ipv4_network, std::string, ipv4_network_bitstring_traits> routing_table;
+	routing_table.insert(ipv4_network{ htonl(0x00000000u), 3 }, "/3");
+	routing_table.insert(ipv4_network{ htonl(0x00000000u), 4 }, "/4");
+	routing_table.insert(ipv4_network{ htonl(0x08000000u), 5 }, "/5");
+	routing_table.insert(ipv4_network{ htonl(0x0a000000u), 7 }, "/7");
+
+	for (uint32_t address: { 0x0a010203u, 0x09000001u, 0x04000001u, 0x10000001u, 0x20000001u }) {
+		std::string const* const value = routing_table.value(ipv4_network{ htonl(address) });
+		std::cout << (value ? *value : "none") << "\n";
+	}
+	std::cout << "nodes: " << routing_table.node_count() << "\n";
+
+	routing_table.erase(ipv4_network{ htonl(0x00000000u), 4 });
+	std::cout << *routing_table.value(ipv4_network{ htonl(0x04000001u) }) << "\n";
+	routing_table.erase(ipv4_network{ htonl(0x08000000u), 5 });
+	routing_table.erase(ipv4_network{ htonl(0x0a000000u), 7 });
+	std::cout << "nodes: " << routing_table.node_count() << "\n";
+}
+
+// copying throws while `fail` is set
+struct failing_value {
+	static bool fail;
+
+	failing_value() = default;
+	failing_value(failing_value const&) {
+		if (fail) throw std::runtime_error("copy failed");
+	}
+	failing_value& operator=(failing_value const&) = default;
+};
+
+bool failing_value::fail = false;
+
+void run_insert_failure() {
+	tree_bitmap<ipv4_network, failing_value, ipv4_network_bitstring_traits> routing_table;
+	failing_value const value;
+	routing_table.insert(ipv4_network{ htonl(0x0a000000u), 8 }, value);
+	std::cout << "nodes: " << routing_table.node_count() << "\n";
+
+	// needs eight new nodes below the root
+	failing_value::fail = true;
+	try {
+		routing_table.insert(ipv4_network{ htonl(0xc0000201u), 32 }, value);
+	} catch (std::runtime_error const& e) {
+		std::cout << e.what() << "\n";
+	}
+	failing_value::fail = false;
+	std::cout << "size: " << routing_table.size() << ", nodes: " << routing_table.node_count() << "\n";
+}
+
+int main() {
+	run_ipv4_network();
+	run_stride_boundaries();
+	run_insert_failure();
+	run_ipv6_network();
+	return 0;
+}
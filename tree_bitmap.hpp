@@ -0,0 +1,468 @@
+#pragma once
+
+#include "bitstring.hpp"
+#include "builtins.hpp"
+#include "table_generation.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <stddef.h>
+#include <stdint.h>
+
+// multibit trie with compressed nodes (Eatherton et al., "Tree Bitmap: Hardware/Software IP
+// Lookups with Incremental Updates").
+//
+// every node covers `Stride` bits of the key: the "internal" bitmap marks which of the
+// 2^Stride - 1 prefixes with 0 to Stride - 1 bits (relative to the node) are stored in the
+// node, the "external" bitmap which of the 2^Stride possible children exist. a node only has
+// two pointers: to the array of its children and to the array of its entries, both in bitmap
+// order; the position of an element in its array is the number of set bits before its bit in
+// the bitmap. a lookup reads one node per `Stride` bits of the key (and at the end the entry
+// of the longest match found on the way).
+//
+// there are no iterators; lookups return pointers to the values (which are invalidated by
+// inserting or erasing in the same node), and for_each() visits all entries.
+template<typename Key, typename Value, typename KeyBitStringTraits, unsigned int Stride = 4>
+class tree_bitmap {
+	static_assert(Stride >= 1 && Stride <= 5, "Stride must be between 1 and 5 (bitmaps are 32 bit)");
+
+public:
+	typedef Key key_t;
+	typedef Value value_t;
+
+	static constexpr unsigned int STRIDE{Stride};
+
+	class element_type {
+	private:
+		friend class tree_bitmap;
+
+		key_t m_key{};
+		value_t m_value{};
+
+	public:
+		element_type() = default;
+		template<typename ArgKey, typename ArgValue>
+		explicit element_type(ArgKey&& key, ArgValue&& value)
+		: m_key(std::forward<ArgKey>(key)), m_value(std::forward<ArgValue>(value)) {
+		}
+
+		key_t const& key() const { return m_key; }
+		value_t const& value() const { return m_value; }
+		value_t& value() { return m_value; }
+	};
+
+private:
+	typedef typename KeyBitStringTraits::bitstring bitstring;
+	typedef uint32_t bitmap_t;
+
+	// owns the arrays; destroy() frees them
+	struct node {
+		// bit (2^l - 1 + p): prefix of length l with bits p (relative to the node)
+		bitmap_t m_internal{0};
+		// bit c: child for the next Stride bits c
+		bitmap_t m_external{0};
+		node* m_children{nullptr};
+		element_type* m_results{nullptr};
+	};
+
+	node m_root;
+	size_t m_size{0};
+	// nodes including the root
+	size_t m_node_count{1};
+	table_generation m_generation;
+
+	static bitstring key_to_bs(key_t const& key) {
+		KeyBitStringTraits keyBitStringTraits{};
+		return keyBitStringTraits.value_to_bitstring(key);
+	}
+
+	static size_t popcount(bitmap_t bitmap) {
+		return builtins_detail::popcount(bitmap);
+	}
+
+	// position in the array for given bit
+	static size_t rank(bitmap_t bitmap, size_t bit) {
+		return popcount(bitmap & ((bitmap_t{1} << bit) - 1));
+	}
+
+	static bool test(bitmap_t bitmap, size_t bit) {
+		return 0 != (bitmap & (bitmap_t{1} << bit));
+	}
+
+	static size_t internal_bit(size_t length, size_t bits) {
+		return (size_t{1} << length) - 1 + bits;
+	}
+
+	// `count` bits of `bs` starting at `offset` as number (first bit is the most significant)
+	static size_t chunk(bitstring const& bs, size_t offset, size_t count) {
+		size_t result = 0;
+		for (size_t i = 0; i < count; ++i) result = (result << 1) | (bs[offset + i] ? 1u : 0u);
+		return result;
+	}
+
+	// new array of count + 1 elements with the new element (constructed from args) at pos
+	template<typename T, typename... Args>
+	static T* array_insert(T* array, size_t count, size_t pos, Args&&... args) {
+		std::allocator<T> allocator;
+		T* const result = allocator.allocate(count + 1);
+		try {
+			::new (static_cast<void*>(result + pos)) T(std::forward<Args>(args)...);
+		} catch (...) {
+			allocator.deallocate(result, count + 1);
+			throw;
+		}
+		for (size_t i = 0; i < count; ++i) {
+			::new (static_cast<void*>(result + i + (i < pos ? 0 : 1))) T(std::move(array[i]));
+		}
+		array_free(array, count);
+		return result;
+	}
+
+	// new array of count - 1 elements without the element at pos
+	template<typename T>
+	static T* array_erase(T* array, size_t count, size_t pos) {
+		T* result = nullptr;
+		if (count > 1) {
+			result = std::allocator<T>().allocate(count - 1);
+			for (size_t i = 0; i + 1 < count; ++i) {
+				::new (static_cast<void*>(result + i)) T(std::move(array[i + (i < pos ? 0 : 1)]));
+			}
+		}
+		array_free(array, count);
+		return result;
+	}
+
+	template<typename T>
+	static void array_free(T* array, size_t count) {
+		if (!array) return;
+		for (size_t i = 0; i < count; ++i) array[i].~T();
+		std::allocator<T>().deallocate(array, count);
+	}
+
+	static void destroy(node& n) {
+		size_t const children = popcount(n.m_external);
+		for (size_t i = 0; i < children; ++i) destroy(n.m_children[i]);
+		array_free(n.m_children, children);
+		array_free(n.m_results, popcount(n.m_internal));
+		n = node();
+	}
+
+	// dst must be empty; on exceptions dst is left in a state destroy() can handle
+	static void copy(node const& src, node& dst) {
+		size_t const results = popcount(src.m_internal);
+		if (results) {
+			std::allocator<element_type> allocator;
+			element_type* const array = allocator.allocate(results);
+			size_t i = 0;
+			try {
+				for (; i < results; ++i) ::new (static_cast<void*>(array + i)) element_type(src.m_results[i]);
+			} catch (...) {
+				while (i-- > 0) array[i].~element_type();
+				allocator.deallocate(array, results);
+				throw;
+			}
+			dst.m_results = array;
+			dst.m_internal = src.m_internal;
+		}
+		size_t const children = popcount(src.m_external);
+		if (children) {
+			node* const array = std::allocator<node>().allocate(children);
+			for (size_t i = 0; i < children; ++i) ::new (static_cast<void*>(array + i)) node();
+			dst.m_children = array;
+			dst.m_external = src.m_external;
+			for (size_t i = 0; i < children; ++i) copy(src.m_children[i], array[i]);
+		}
+	}
+
+	// (the arrays aren't const in a const node)
+	element_type* intern_find(bitstring const& bs) const {
+		size_t const length = bs.length();
+		node const* n = &m_root;
+		element_type* result = nullptr;
+		for (size_t offset = 0; ; offset += Stride) {
+			size_t const count = std::min<size_t>(length - offset, Stride);
+			size_t const bits = chunk(bs, offset, count);
+			if (n->m_internal) {
+				// longest prefix in this node first
+				for (size_t l = std::min<size_t>(count, Stride - 1) + 1; l-- > 0; ) {
+					size_t const bit = internal_bit(l, bits >> (count - l));
+					if (test(n->m_internal, bit)) {
+						result = &n->m_results[rank(n->m_internal, bit)];
+						break;
+					}
+				}
+			}
+			if (count < Stride || !test(n->m_external, bits)) return result;
+			n = &n->m_children[rank(n->m_external, bits)];
+		}
+	}
+
+	element_type* intern_find_exact(bitstring const& bs) const {
+		size_t const length = bs.length();
+		node const* n = &m_root;
+		size_t offset = 0;
+		for (; length - offset >= Stride; offset += Stride) {
+			size_t const bits = chunk(bs, offset, Stride);
+			if (!test(n->m_external, bits)) return nullptr;
+			n = &n->m_children[rank(n->m_external, bits)];
+		}
+		size_t const bit = internal_bit(length - offset, chunk(bs, offset, length - offset));
+		if (!test(n->m_internal, bit)) return nullptr;
+		return &n->m_results[rank(n->m_internal, bit)];
+	}
+
+	template<typename ValueArg>
+	std::pair<value_t*, bool> intern_insert(key_t const& key, ValueArg&& value, bool assign) {
+		bitstring const bs = key_to_bs(key);
+		size_t const length = bs.length();
+		node* n = &m_root;
+		size_t offset = 0;
+		for (; length - offset >= Stride; offset += Stride) {
+			size_t const bits = chunk(bs, offset, Stride);
+			if (!test(n->m_external, bits)) break;
+			n = &n->m_children[rank(n->m_external, bits)];
+		}
+		if (length - offset >= Stride) return insert_branch(n, offset, bs, key, std::forward<ValueArg>(value));
+
+		size_t const bit = internal_bit(length - offset, chunk(bs, offset, length - offset));
+		size_t const pos = rank(n->m_internal, bit);
+		if (test(n->m_internal, bit)) {
+			element_type& elem = n->m_results[pos];
+			if (assign) {
+				elem.m_value = std::forward<ValueArg>(value);
+				m_generation.bump();
+			}
+			return std::make_pair(&elem.m_value, false);
+		}
+		n->m_results = array_insert(n->m_results, popcount(n->m_internal), pos, key, std::forward<ValueArg>(value));
+		n->m_internal |= bitmap_t{1} << bit;
+		++m_size;
+		m_generation.bump();
+		return std::make_pair(&n->m_results[pos].m_value, true);
+	}
+
+	// insert a key which needs new nodes below n (which covers the bits from offset): builds
+	// the new nodes with the entry outside the tree first and then links them, so an
+	// exception leaves the tree unchanged
+	template<typename ValueArg>
+	std::pair<value_t*, bool> insert_branch(node* n, size_t offset, bitstring const& bs, key_t const& key, ValueArg&& value) {
+		size_t const length = bs.length();
+		size_t const new_nodes = (length - offset) / Stride;
+		size_t const leaf_offset = offset + new_nodes * Stride;
+		node branch;
+		value_t* result;
+		try {
+			branch.m_results = array_insert(branch.m_results, 0, 0, key, std::forward<ValueArg>(value));
+			branch.m_internal = bitmap_t{1} << internal_bit(length - leaf_offset, chunk(bs, leaf_offset, length - leaf_offset));
+			result = &branch.m_results[0].m_value;
+			for (size_t child_offset = leaf_offset; child_offset > offset + Stride; child_offset -= Stride) {
+				node parent;
+				parent.m_children = array_insert(parent.m_children, 0, 0, branch);
+				parent.m_external = bitmap_t{1} << chunk(bs, child_offset - Stride, Stride);
+				branch = parent;
+			}
+			size_t const bits = chunk(bs, offset, Stride);
+			n->m_children = array_insert(n->m_children, popcount(n->m_external), rank(n->m_external, bits), branch);
+			n->m_external |= bitmap_t{1} << bits;
+		} catch (...) {
+			destroy(branch);
+			throw;
+		}
+		m_node_count += new_nodes;
+		++m_size;
+		m_generation.bump();
+		return std::make_pair(result, true);
+	}
+
+	template<typename Function>
+	static void intern_for_each(node const& n, Function& f) {
+		size_t const results = popcount(n.m_internal);
+		for (size_t i = 0; i < results; ++i) f(n.m_results[i]);
+		size_t const children = popcount(n.m_external);
+		for (size_t i = 0; i < children; ++i) intern_for_each(n.m_children[i], f);
+	}
+
+public:
+	tree_bitmap() = default;
+
+	tree_bitmap(tree_bitmap const& other)
+	: m_size(other.m_size), m_node_count(other.m_node_count) {
+		try {
+			copy(other.m_root, m_root);
+		} catch (...) {
+			destroy(m_root);
+			throw;
+		}
+	}
+
+	tree_bitmap(tree_bitmap&& other)
+	: m_root(other.m_root), m_size(other.m_size), m_node_count(other.m_node_count), m_generation(std::move(other.m_generation)) {
+		other.m_root = node();
+		other.m_size = 0;
+		other.m_node_count = 1;
+	}
+
+	tree_bitmap& operator=(tree_bitmap const& other) {
+		if (this != &other) {
+			tree_bitmap tmp(other);
+			swap(*this, tmp);
+		}
+		return *this;
+	}
+
+	tree_bitmap& operator=(tree_bitmap&& other) {
+		if (this != &other) {
+			tree_bitmap tmp(std::move(other));
+			swap(*this, tmp);
+		}
+		return *this;
+	}
+
+	~tree_bitmap() {
+		destroy(m_root);
+	}
+
+	// value from entry with longest matching prefix of key or nullptr
+	value_t const* value(key_t const& key) const {
+		element_type const* const elem = intern_find(key_to_bs(key));
+		return elem ? &elem->m_value : nullptr;
+	}
+
+	value_t* value(key_t const& key) {
+		element_type* const elem = intern_find(key_to_bs(key));
+		return elem ? &elem->m_value : nullptr;
+	}
+
+	// same by address (see KeyBitStringTraits::address_to_bitstring in bitstring.hpp)
+	template<typename Address, typename = decltype(traits_address_to_bitstring<KeyBitStringTraits>(std::declval<Address const&>()))>
+	value_t const* value(Address const& address) const {
+		element_type const* const elem = intern_find(traits_address_to_bitstring<KeyBitStringTraits>(address));
+		return elem ? &elem->m_value : nullptr;
+	}
+
+	// value from entry with key equal to given key or nullptr
+	value_t const* value_exact(key_t const& key) const {
+		element_type const* const elem = intern_find_exact(key_to_bs(key));
+		return elem ? &elem->m_value : nullptr;
+	}
+
+	value_t* value_exact(key_t const& key) {
+		element_type* const elem = intern_find_exact(key_to_bs(key));
+		return elem ? &elem->m_value : nullptr;
+	}
+
+	// insert, but don't overwrite existing entry (returns false if key is already present)
+	template<typename ValueArg>
+	std::pair<value_t*, bool> insert(key_t const& key, ValueArg&& value) {
+		return intern_insert(key, std::forward<ValueArg>(value), false);
+	}
+
+	// insert, or assign if key is already present
+	template<typename ValueArg>
+	std::pair<value_t*, bool> insert_or_assign(key_t const& key, ValueArg&& value) {
+		return intern_insert(key, std::forward<ValueArg>(value), true);
+	}
+
+	// insert all (key, value) pairs from the given range, but don't overwrite existing entries
+	template<typename InputIterator>
+	void insert(InputIterator first, InputIterator last) {
+		for (; first != last; ++first) intern_insert(first->first, first->second, false);
+	}
+
+	// insert, or assign if key is already present, all (key, value) pairs from the given range
+	template<typename InputIterator>
+	void insert_or_assign(InputIterator first, InputIterator last) {
+		for (; first != last; ++first) intern_insert(first->first, first->second, true);
+	}
+
+	// erase element with given key (and nodes which become empty). returns how many elements
+	// were deleted (0 or 1)
+	size_t erase(key_t const& key) {
+		bitstring const bs = key_to_bs(key);
+		size_t const length = bs.length();
+		std::vector<node*> path{&m_root};
+		size_t offset = 0;
+		for (; length - offset >= Stride; offset += Stride) {
+			node* const n = path.back();
+			size_t const bits = chunk(bs, offset, Stride);
+			if (!test(n->m_external, bits)) return 0;
+			path.push_back(&n->m_children[rank(n->m_external, bits)]);
+		}
+		node* const n = path.back();
+		size_t const bit = internal_bit(length - offset, chunk(bs, offset, length - offset));
+		if (!test(n->m_internal, bit)) return 0;
+		n->m_results = array_erase(n->m_results, popcount(n->m_internal), rank(n->m_internal, bit));
+		n->m_internal &= ~(bitmap_t{1} << bit);
+		--m_size;
+		m_generation.bump();
+
+		// remove empty nodes bottom-up
+		for (size_t depth = path.size() - 1; depth > 0; --depth) {
+			node* const child = path[depth];
+			if (child->m_internal || child->m_external) break;
+			node* const parent = path[depth - 1];
+			size_t const bits = chunk(bs, (depth - 1) * Stride, Stride);
+			parent->m_children = array_erase(parent->m_children, popcount(parent->m_external), rank(parent->m_external, bits));
+			parent->m_external &= ~(bitmap_t{1} << bits);
+			--m_node_count;
+		}
+		return 1;
+	}
+
+	void clear() {
+		destroy(m_root);
+		m_size = 0;
+		m_node_count = 1;
+		m_generation.bump();
+	}
+
+	// calls `f(key, value)` for all entries: per node first its own entries (shorter prefixes
+	// first), then the subtrees of its children in key order. `f` must not modify the table.
+	template<typename Function>
+	void for_each(Function&& f) const {
+		auto visit = [&f](element_type const& elem) { f(elem.key(), elem.value()); };
+		intern_for_each(m_root, visit);
+	}
+
+	template<typename Function>
+	void for_each(Function&& f) {
+		auto visit = [&f](element_type& elem) { f(elem.key(), elem.value()); };
+		intern_for_each(m_root, visit);
+	}
+
+	bool empty() const {
+		return 0 == m_size;
+	}
+
+	size_t size() const {
+		return m_size;
+	}
+
+	size_t node_count() const {
+		return m_node_count;
+	}
+
+	// bytes allocated for the table itself (not counting memory owned by keys or values)
+	size_t memory_usage() const {
+		return sizeof(*this) + (m_node_count - 1) * sizeof(node) + m_size * sizeof(element_type);
+	}
+
+	// changes on every modification of the table (see table_generation)
+	uint64_t generation() const {
+		return m_generation.value();
+	}
+
+	friend void swap(tree_bitmap& a, tree_bitmap& b) {
+		using std::swap;
+		swap(a.m_root, b.m_root);
+		swap(a.m_size, b.m_size);
+		swap(a.m_node_count, b.m_node_count);
+		swap(a.m_generation, b.m_generation);
+	}
+};
+
+template<typename Key, typename Value, typename KeyBitStringTraits, unsigned int Stride>
+constexpr unsigned int tree_bitmap<Key, Value, KeyBitStringTraits, Stride>::STRIDE;
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include <cassert>
+
+#include <stddef.h>
+#include <stdint.h>
+
+// deduplicated, reference counted values addressed by small integer ids (e.g. the few hundred
+// distinct next hops of a routing table with millions of prefixes).
+//
+// acquire() returns the id of an equal value already in the pool (or stores a new one) and
+// adds a reference; release() drops one and frees the id when the last reference is gone
+// (freed ids are reused). references to values stay valid until their id is freed.
+template<typename Value, typename Id = uint16_t, typename Hash = std::hash<Value>, typename KeyEqual = std::equal_to<Value>>
+class value_pool {
+	static_assert(std::is_unsigned<Id>::value, "Id must be an unsigned integer type");
+
+public:
+	typedef Value value_t;
+	typedef Id id_t;
+
+private:
+	struct slot {
+		value_t m_value;
+		// 0: unused (id is in m_free)
+		size_t m_refs;
+	};
+
+	// deque: references to values stay valid when new ids are added
+	std::deque<slot> m_slots;
+	std::vector<id_t> m_free;
+	std::unordered_map<value_t, id_t, Hash, KeyEqual> m_index;
+
+	void free_id(id_t id) {
+		m_index.erase(m_slots[id].m_value);
+		m_free.push_back(id);
+	}
+
+public:
+	// id of a value equal to the given value, adding a reference
+	id_t acquire(value_t const& value) {
+		auto const it = m_index.find(value);
+		if (it != m_index.end()) {
+			++m_slots[it->second].m_refs;
+			return it->second;
+		}
+		id_t id;
+		if (!m_free.empty()) {
+			id = m_free.back();
+			m_slots[id].m_value = value;
+			m_index.emplace(value, id);
+			m_free.pop_back();
+		} else {
+			if (m_slots.size() > std::numeric_limits<id_t>::max()) throw std::length_error("value_pool: too many distinct values");
+			id = static_cast<id_t>(m_slots.size());
+			m_slots.push_back(slot{value, 0});
+			try {
+				m_index.emplace(value, id);
+			} catch (...) {
+				m_slots.pop_back();
+				throw;
+			}
+		}
+		m_slots[id].m_refs = 1;
+		return id;
+	}
+
+	// add a reference to an id in use
+	void add_ref(id_t id) {
+		assert(id < m_slots.size() && 0 != m_slots[id].m_refs);
+		++m_slots[id].m_refs;
+	}
+
+	// drop a reference to an id in use
+	void release(id_t id) {
+		assert(id < m_slots.size() && 0 != m_slots[id].m_refs);
+		if (0 == --m_slots[id].m_refs) free_id(id);
+	}
+
+	// set the reference counts of all ids to the number of times they appear in the given range
+	// of ids (ids not in the range are freed)
+	template<typename InputIterator>
+	void recount(InputIterator first, InputIterator last) {
+		std::vector<size_t> refs(m_slots.size(), 0);
+		for (; first != last; ++first) {
+			assert(*first < m_slots.size() && 0 != m_slots[*first].m_refs);
+			++refs[*first];
+		}
+		for (size_t id = 0; id < m_slots.size(); ++id) {
+			if (0 == m_slots[id].m_refs) continue;
+			m_slots[id].m_refs = refs[id];
+			if (0 == refs[id]) free_id(static_cast<id_t>(id));
+		}
+	}
+
+	// replace the value of an id in use for all its references; fails (returns false) if the
+	// new value already has another id
+	bool replace(id_t id, value_t const& value) {
+		assert(id < m_slots.size() && 0 != m_slots[id].m_refs);
+		auto const it = m_index.find(value);
+		if (it != m_index.end()) return it->second == id;
+		m_index.emplace(value, id);
+		m_index.erase(m_slots[id].m_value);
+		m_slots[id].m_value = value;
+		return true;
+	}
+
+	// id of a value equal to the given value (without adding a reference); returns false if
+	// there is none
+	bool find(value_t const& value, id_t& id) const {
+		auto const it = m_index.find(value);
+		if (it == m_index.end()) return false;
+		id = it->second;
+		return true;
+	}
+
+	value_t const& operator[](id_t id) const {
+		assert(id < m_slots.size() && 0 != m_slots[id].m_refs);
+		return m_slots[id].m_value;
+	}
+
+	size_t references(id_t id) const {
+		return (id < m_slots.size()) ? m_slots[id].m_refs : 0;
+	}
+
+	// number of distinct values
+	size_t size() const {
+		return m_index.size();
+	}
+
+	// bytes allocated for the pool (approximate for the hash index; not counting memory owned
+	// by values)
+	size_t memory_usage() const {
+		return sizeof(*this) + m_slots.size() * sizeof(slot) + m_free.capacity() * sizeof(id_t)
+			+ m_index.bucket_count() * sizeof(void*) + m_index.size() * (sizeof(value_t) + sizeof(id_t) + 2 * sizeof(void*));
+	}
+};